@@ -15,6 +15,7 @@ import argparse
 import asyncio
 import json
 import math
+import struct
 import sys
 from pathlib import Path
 from typing import Any, Dict, Optional, Set
@@ -29,14 +30,65 @@ from kinematics import KinematicsCalculator
 from memory import MemoryManager
 
 
+BINARY_MAGIC = b"TRK1"
+BINARY_HEADER = struct.Struct("<4sHHQd")
+BINARY_TAG = struct.Struct("<HBxffff")
+SATELLITE_TAG_ID = 0
+END_MASS_TAG_ID = 1
+
+
+def decode_binary_contract(data: bytes) -> Optional[Dict[str, Any]]:
+    """Packed binary detector output (docs/api.md section 4) as a contract dict.
+
+    Returns None unless the satellite and primary end mass are both visible,
+    matching when the JSON contract is sent.
+    """
+    if len(data) < BINARY_HEADER.size:
+        return None
+    _, camera, count, frame_id, timestamp = BINARY_HEADER.unpack_from(data)
+    if len(data) < BINARY_HEADER.size + count * BINARY_TAG.size:
+        return None
+
+    tags = {}
+    for i in range(count):
+        tag_id, visible, x, y, yaw, conf = BINARY_TAG.unpack_from(
+            data, BINARY_HEADER.size + i * BINARY_TAG.size
+        )
+        tags[tag_id] = (visible, x, y, conf)
+
+    sat = tags.get(SATELLITE_TAG_ID)
+    end = tags.get(END_MASS_TAG_ID)
+    if not sat or not end or not sat[0] or not end[0]:
+        return None
+
+    orbital = math.atan2(end[2] - sat[2], end[1] - sat[1])
+    return {
+        "timestamp": timestamp,
+        "frame_id": frame_id,
+        "camera_id": f"cam{camera}",
+        "satellite_position": {"x": sat[1], "y": sat[2]},
+        "end_mass_position": {"x": end[1], "y": end[2]},
+        "orbital_angular_position": orbital,
+        "tracking_confidence": min(sat[3], end[3]),
+    }
+
+
 class UdpReceiverProtocol(asyncio.DatagramProtocol):
-    """Collect UDP datagrams into an asyncio queue."""
+    """Collect UDP datagrams into an asyncio queue.
+
+    JSON datagrams are queued as text, binary ones ("TRK1") already decoded.
+    """
 
     def __init__(self, queue: asyncio.Queue):
         self.queue = queue
 
     def datagram_received(self, data: bytes, addr):
         try:
+            if data[:4] == BINARY_MAGIC:
+                payload = decode_binary_contract(data)
+                if payload is not None:
+                    self.queue.put_nowait(payload)
+                return
             message = data.decode("utf-8").strip()
             if message:
                 self.queue.put_nowait(message)
@@ -56,7 +108,7 @@ class CppStreamBridge:
     ):
         self.ws_port = ws_port
         self.udp_port = udp_port
-        self.udp_queue: Optional[asyncio.Queue[str]] = None
+        self.udp_queue: Optional[asyncio.Queue] = None
         self.ws_clients: Set[Any] = set()
 
         self.memory = MemoryManager(buffer_size=buffer_size)
@@ -137,10 +189,13 @@ class CppStreamBridge:
             raise RuntimeError("UDP queue is not initialized")
         while True:
             message = await self.udp_queue.get()
-            try:
-                payload = json.loads(message)
-            except json.JSONDecodeError:
-                continue
+            if isinstance(message, dict):
+                payload = message
+            else:
+                try:
+                    payload = json.loads(message)
+                except json.JSONDecodeError:
+                    continue
 
             if not self._validate_detector_payload(payload):
                 continue
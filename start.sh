@@ -113,10 +113,16 @@ FLASK_PID=$!
 sleep 2
 
 # ── 4. Detector bridge: UDP (C++ vision) -> WebSocket (GUI) ─
-echo "      Starting cpp_stream_bridge (UDP 9001 -> ws 8080)..."
-("$PYTHON_BIN" -u "$REPO_DIR/src/camera/cpp_stream_bridge.py" >> "$LOG_DIR/bridge.log" 2>&1) &
-BRIDGE_PID=$!
-sleep 1
+# VISION_WS=1 lets the vision binary serve ws 8080 itself (--ws-port 8080)
+# and skips the Python bridge.
+if [[ "${VISION_WS:-}" == "1" ]]; then
+  echo "      (cpp_stream_bridge skipped: vision serves ws 8080 directly)"
+else
+  echo "      Starting cpp_stream_bridge (UDP 9001 -> ws 8080)..."
+  ("$PYTHON_BIN" -u "$REPO_DIR/src/camera/cpp_stream_bridge.py" >> "$LOG_DIR/bridge.log" 2>&1) &
+  BRIDGE_PID=$!
+  sleep 1
+fi
 
 # ── 5. AprilTag vision (optional; Pi / built binary) ─
 # Game mode: set GAME_MODE=1 (and optionally PUCK_TAG_ID, default 1) to launch
@@ -128,6 +134,9 @@ if [[ "${GAME_MODE:-}" == "1" ]]; then
   PUCK_TAG_ID="${PUCK_TAG_ID:-1}"
   VISION_ARGS+=( --single-tag "$PUCK_TAG_ID" )
 fi
+if [[ "${VISION_WS:-}" == "1" ]]; then
+  VISION_ARGS+=( --ws-port 8080 )
+fi
 if [[ -x "$VISION_BIN" ]]; then
   echo "      Starting AprilTag vision (${VISION_ARGS[*]})..."
   ("$VISION_BIN" "${VISION_ARGS[@]}" >> "$LOG_DIR/vision.log" 2>&1) &
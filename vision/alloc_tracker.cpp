@@ -0,0 +1,113 @@
+#include "alloc_tracker.hpp"
+
+#ifdef TRACKER_ALLOC_TRACKING
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include <execinfo.h>
+#include <unistd.h>
+
+// Plain thread_locals: no constructors, so operator new can touch them
+// from any thread at any time (including before main()).
+static thread_local uint64_t allocCount    = 0;
+static thread_local uint64_t allocBytes    = 0;
+static thread_local bool     allocStrictOn = false;
+static thread_local bool     backtraceWarm = false;
+
+static void strictViolation(size_t size)
+{
+    allocStrictOn = false;   // the report itself must not recurse
+
+    char msg[96];
+    const int len = snprintf(msg, sizeof(msg),
+                             "[ERROR] alloc-strict: %zu-byte allocation on the tracking thread\n",
+                             size);
+    (void)!write(STDERR_FILENO, msg, len);
+
+    void* frames[64];
+    const int n = backtrace(frames, 64);
+    backtrace_symbols_fd(frames, n, STDERR_FILENO);
+    std::abort();
+}
+
+static void* countedAlloc(size_t size, size_t align)
+{
+    if (allocStrictOn) strictViolation(size);
+    ++allocCount;
+    allocBytes += size;
+
+    if (size == 0) size = 1;
+    void* p = nullptr;
+    if (align <= alignof(std::max_align_t))
+        p = std::malloc(size);
+    else if (posix_memalign(&p, align, size) != 0)
+        p = nullptr;
+    return p;
+}
+
+static void* countedNew(size_t size, size_t align)
+{
+    void* p = countedAlloc(size, align);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size)          { return countedNew(size, 0); }
+void* operator new[](size_t size)        { return countedNew(size, 0); }
+void* operator new(size_t size, std::align_val_t a)   { return countedNew(size, static_cast<size_t>(a)); }
+void* operator new[](size_t size, std::align_val_t a) { return countedNew(size, static_cast<size_t>(a)); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept   { return countedAlloc(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size, 0); }
+
+void operator delete(void* p) noexcept                        { std::free(p); }
+void operator delete[](void* p) noexcept                      { std::free(p); }
+void operator delete(void* p, size_t) noexcept                { std::free(p); }
+void operator delete[](void* p, size_t) noexcept              { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept      { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept    { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept   { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+AllocCounts threadAllocs()
+{
+    return { allocCount, allocBytes };
+}
+
+void allocStrict(bool on)
+{
+    if (on && !backtraceWarm)
+    {
+        // The first backtrace() loads libgcc_s, which allocates; do it now.
+        void* frame;
+        backtrace(&frame, 1);
+        backtraceWarm = true;
+    }
+    allocStrictOn = on;
+}
+
+bool allocStrictArmed()
+{
+    return allocStrictOn;
+}
+
+#else
+
+AllocCounts threadAllocs()
+{
+    return {};
+}
+
+void allocStrict(bool)
+{
+}
+
+bool allocStrictArmed()
+{
+    return false;
+}
+
+#endif
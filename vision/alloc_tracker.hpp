@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+// ============================================================
+// ALLOCATION TRACKING
+//
+// Instrumentation build only (cmake -DTRACKER_ALLOC_TRACKING=ON): the
+// global operator new / delete are replaced to count allocations and
+// bytes per thread.  The per-camera summary and /metrics then report
+// what each tracking thread allocates per frame.
+//
+// allocStrict(true) makes the next operator new on the calling thread
+// print a backtrace and abort; --alloc-strict arms it in trackingThread
+// after warm-up, so allocation-free tracking can be enforced as a
+// regression check.  Third-party calls that allocate internally
+// (cv::solvePnP on a pose-cache miss) run under an AllocStrictPause;
+// their allocations are still counted.
+//
+// Only C++ allocations are seen: malloc() inside libapriltag and the
+// pixel data of a cv::Mat (cv::fastMalloc) are not.  Each cv::Mat buffer
+// allocation also news its UMatData header, though, so a Mat that
+// (re)allocates is still caught.
+// ============================================================
+
+#ifdef TRACKER_ALLOC_TRACKING
+constexpr bool ALLOC_TRACKING = true;
+#else
+constexpr bool ALLOC_TRACKING = false;
+#endif
+
+struct AllocCounts
+{
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+// Cumulative operator new calls / bytes on the calling thread (zeros
+// when ALLOC_TRACKING is off).
+AllocCounts threadAllocs();
+
+// Abort with a backtrace on the calling thread's next allocation.
+void allocStrict(bool on);
+bool allocStrictArmed();
+
+// Strict mode off on the calling thread for one scope, if it was on
+class AllocStrictPause
+{
+public:
+    AllocStrictPause() : armed_(allocStrictArmed()) { if (armed_) allocStrict(false); }
+    ~AllocStrictPause() { if (armed_) allocStrict(true); }
+
+    AllocStrictPause(const AllocStrictPause&)            = delete;
+    AllocStrictPause& operator=(const AllocStrictPause&) = delete;
+
+private:
+    bool armed_;
+};
@@ -0,0 +1,295 @@
+#include "async_logger.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+
+AsyncLogger logger;
+
+static int64_t steadyNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char* levelTag(LogLevel level)
+{
+    switch (level)
+    {
+        case LogLevel::Debug: return "[DEBUG] ";
+        case LogLevel::Info:  return "[INFO] ";
+        case LogLevel::Warn:  return "[WARN] ";
+        case LogLevel::Error: return "[ERROR] ";
+    }
+    return "";
+}
+
+// ============================================================
+// STRING FORMATTING
+// ============================================================
+
+void appendf(std::string& out, const char* fmt, ...)
+{
+    char buf[512];
+    va_list ap, again;
+    va_start(ap, fmt);
+    va_copy(again, ap);
+    const int n = std::vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n > 0 && static_cast<size_t>(n) < sizeof(buf))
+    {
+        out.append(buf, static_cast<size_t>(n));
+    }
+    else if (n > 0)
+    {
+        const size_t at = out.size();
+        out.resize(at + static_cast<size_t>(n) + 1);
+        std::vsnprintf(&out[at], static_cast<size_t>(n) + 1, fmt, again);
+        out.resize(at + static_cast<size_t>(n));
+    }
+    va_end(again);
+}
+
+// ============================================================
+// RECORD
+// ============================================================
+
+void AsyncLogger::Record::appendf(const char* fmt, ...)
+{
+    if (!buf_ || len_ >= LOG_SLOT_BYTES - 1) return;
+
+    va_list args;
+    va_start(args, fmt);
+    const int n = std::vsnprintf(buf_ + len_, LOG_SLOT_BYTES - len_, fmt, args);
+    va_end(args);
+
+    // Truncate rather than fail; the record stays well-formed up to the cut.
+    if (n > 0) len_ = std::min(len_ + static_cast<size_t>(n), LOG_SLOT_BYTES - 1);
+}
+
+void AsyncLogger::Record::append(const char* text, size_t len)
+{
+    if (!buf_) return;
+    const size_t n = std::min(len, LOG_SLOT_BYTES - 1 - len_);
+    std::memcpy(buf_ + len_, text, n);
+    len_ += n;
+}
+
+// ============================================================
+// ASYNC LOGGER
+// ============================================================
+
+AsyncLogger::AsyncLogger()
+    : slots_(new std::array<Slot, LOG_SLOTS>)
+{
+    for (size_t i = 0; i < LOG_SLOTS; ++i)
+        (*slots_)[i].seq.store(i, std::memory_order_relaxed);
+
+    for (auto& p : periodNs_) p = -1;
+    for (auto& n : nextNs_)   n = 0;
+    setRate(LogChannel::Pose, 1.0);
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    stop();
+    delete slots_;
+}
+
+void AsyncLogger::start()
+{
+    if (started_) return;
+    stop_    = false;
+    flusher_ = std::thread(&AsyncLogger::flusherLoop, this);
+    started_ = true;
+}
+
+void AsyncLogger::stop()
+{
+    if (!started_) return;
+    stop_ = true;
+    flusher_.join();
+    started_ = false;
+}
+
+void AsyncLogger::setRate(LogChannel channel, double hz)
+{
+    const size_t c = static_cast<size_t>(channel);
+    if (hz < 0)       periodNs_[c] = -1;
+    else if (hz == 0) periodNs_[c] = std::numeric_limits<int64_t>::max();
+    else              periodNs_[c] = static_cast<int64_t>(1e9 / hz);
+}
+
+bool AsyncLogger::sample(LogChannel channel)
+{
+    const size_t  c      = static_cast<size_t>(channel);
+    const int64_t period = periodNs_[c].load(std::memory_order_relaxed);
+    if (period < 0) return true;
+    if (period == std::numeric_limits<int64_t>::max()) return false;
+
+    const int64_t now  = steadyNs();
+    int64_t       next = nextNs_[c].load(std::memory_order_relaxed);
+    if (now < next) return false;
+    return nextNs_[c].compare_exchange_strong(next, now + period, std::memory_order_relaxed);
+}
+
+AsyncLogger::Record AsyncLogger::begin(LogChannel channel, LogLevel level)
+{
+    Record rec;
+    rec.channel_ = channel;
+    rec.level_   = level;
+    if (level < minLevel_.load(std::memory_order_relaxed)) return rec;
+
+    if (!started_)
+    {
+        // Synchronous fallback: a per-thread buffer written out on commit.
+        thread_local char buf[LOG_SLOT_BYTES];
+        rec.buf_ = buf;
+        rec.pos_ = std::numeric_limits<size_t>::max();
+        return rec;
+    }
+
+    // Bounded MPMC ring (Vyukov): claim position pos when its slot's
+    // sequence equals pos, i.e. the flusher has released it.
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot& slot = (*slots_)[pos & (LOG_SLOTS - 1)];
+        const size_t   seq  = slot.seq.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0)
+        {
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                rec.buf_ = slot.text;
+                rec.pos_ = pos;
+                return rec;
+            }
+        }
+        else if (diff < 0)
+        {
+            ++dropped_;
+            return rec;
+        }
+        else
+        {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void AsyncLogger::commit(Record& rec)
+{
+    if (!rec.buf_) return;
+
+    if (rec.pos_ == std::numeric_limits<size_t>::max())
+    {
+        writeOut(rec.channel_, rec.level_, rec.buf_, rec.len_);
+    }
+    else
+    {
+        Slot& slot   = (*slots_)[rec.pos_ & (LOG_SLOTS - 1)];
+        slot.channel = rec.channel_;
+        slot.level   = rec.level_;
+        slot.len     = static_cast<uint32_t>(rec.len_);
+        slot.seq.store(rec.pos_ + 1, std::memory_order_release);
+    }
+    rec.buf_ = nullptr;
+}
+
+void AsyncLogger::vlogf(LogLevel level, const char* fmt, va_list args)
+{
+    Record rec = begin(LogChannel::Event, level);
+    if (!rec) return;
+
+    const int n = std::vsnprintf(rec.buf_, LOG_SLOT_BYTES, fmt, args);
+    rec.len_ = n > 0 ? std::min(static_cast<size_t>(n), LOG_SLOT_BYTES - 1) : 0;
+    commit(rec);
+}
+
+void AsyncLogger::logf(LogLevel level, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    vlogf(level, fmt, args);
+    va_end(args);
+}
+
+void AsyncLogger::writeOut(LogChannel channel, LogLevel level, const char* text, size_t len)
+{
+    if (channel == LogChannel::Event)
+    {
+        std::fputs(levelTag(level), stderr);
+        std::fwrite(text, 1, len, stderr);
+        std::fputc('\n', stderr);
+    }
+    else
+    {
+        std::fwrite(text, 1, len, stdout);
+        std::fputc('\n', stdout);
+    }
+}
+
+void AsyncLogger::flusherLoop()
+{
+    uint64_t reportedDrops = 0;
+    auto     nextReport    = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        const bool stopping = stop_.load();
+
+        size_t drained = 0;
+        while (true)
+        {
+            Slot& slot = (*slots_)[dequeuePos_ & (LOG_SLOTS - 1)];
+            if (slot.seq.load(std::memory_order_acquire) != dequeuePos_ + 1) break;
+
+            writeOut(slot.channel, slot.level, slot.text, slot.len);
+            slot.seq.store(dequeuePos_ + LOG_SLOTS, std::memory_order_release);
+            ++dequeuePos_;
+            ++drained;
+        }
+        if (drained)
+        {
+            std::fflush(stdout);
+            std::fflush(stderr);
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= nextReport || stopping)
+        {
+            const uint64_t d = dropped_;
+            if (d != reportedDrops)
+            {
+                std::fprintf(stderr, "[WARN] Logger dropped %llu records\n",
+                             static_cast<unsigned long long>(d - reportedDrops));
+                reportedDrops = d;
+            }
+            nextReport = now + std::chrono::seconds(5);
+        }
+
+        if (stopping) return;
+        if (!drained) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+// ============================================================
+// SHORTHANDS
+// ============================================================
+
+#define LOG_FORWARD(level)            \
+    va_list args;                     \
+    va_start(args, fmt);              \
+    logger.vlogf(level, fmt, args);   \
+    va_end(args)
+
+void logDebug(const char* fmt, ...) { LOG_FORWARD(LogLevel::Debug); }
+void logInfo (const char* fmt, ...) { LOG_FORWARD(LogLevel::Info);  }
+void logWarn (const char* fmt, ...) { LOG_FORWARD(LogLevel::Warn);  }
+void logError(const char* fmt, ...) { LOG_FORWARD(LogLevel::Error); }
+
+#undef LOG_FORWARD
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+// ============================================================
+// ASYNC LOGGER
+//
+// Producers format straight into a slot of a fixed ring and return;
+// a background thread writes completed slots to stdout / stderr.
+// Claiming a slot is one CAS, so logging never takes a lock or waits
+// on I/O.  When the ring is full the record is dropped and counted.
+//
+// Channels:
+//   Event    text messages with a severity, to stderr as "[INFO] ..."
+//   Pose     per-frame JSON pose records, to stdout   (default 1 Hz)
+//   Summary  periodic JSON summaries, to stdout       (paced by caller)
+//
+// Each channel has a rate limit checked by sample() before any
+// formatting work is done.  Before start() (and in tools that never
+// call it) records are written synchronously.
+// ============================================================
+
+// printf onto the end of `out`, never truncated.  For text built off the
+// hot path (metrics, control replies, subscriber payloads); log records
+// use Record::appendf.
+void appendf(std::string& out, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+enum class LogLevel : uint8_t { Debug, Info, Warn, Error };
+
+enum class LogChannel : uint8_t { Event, Pose, Summary, Count };
+
+constexpr size_t LOG_SLOT_BYTES = 4096;
+constexpr size_t LOG_SLOTS      = 256;   // power of two
+
+class AsyncLogger
+{
+public:
+    // A claimed slot being filled by one producer.
+    class Record
+    {
+    public:
+        explicit operator bool() const { return buf_ != nullptr; }
+        void appendf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+        void append(const char* text, size_t len);
+
+    private:
+        friend class AsyncLogger;
+        char*      buf_     = nullptr;
+        size_t     len_     = 0;
+        size_t     pos_     = 0;   // ring position, or SIZE_MAX when synchronous
+        LogChannel channel_ = LogChannel::Event;
+        LogLevel   level_   = LogLevel::Info;
+    };
+
+    AsyncLogger();
+    ~AsyncLogger();
+
+    void start();
+    void stop();   // drains everything queued, then joins
+
+    // hz < 0: unlimited, 0: off
+    void setRate(LogChannel channel, double hz);
+    void setMinLevel(LogLevel level) { minLevel_ = level; }
+
+    // True if a record on this channel may be emitted now; consumes the slot.
+    bool sample(LogChannel channel);
+
+    Record begin(LogChannel channel, LogLevel level = LogLevel::Info);
+    void   commit(Record& rec);
+
+    void logf (LogLevel level, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+    void vlogf(LogLevel level, const char* fmt, va_list args);
+
+    uint64_t dropped() const { return dropped_; }
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> seq;
+        LogChannel          channel;
+        LogLevel            level;
+        uint32_t            len;
+        char                text[LOG_SLOT_BYTES];
+    };
+
+    void flusherLoop();
+    static void writeOut(LogChannel channel, LogLevel level, const char* text, size_t len);
+
+    std::array<Slot, LOG_SLOTS>* slots_;
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    alignas(64) size_t              dequeuePos_ = 0;   // flusher only
+
+    std::array<std::atomic<int64_t>, size_t(LogChannel::Count)> periodNs_;
+    std::array<std::atomic<int64_t>, size_t(LogChannel::Count)> nextNs_;
+    std::atomic<LogLevel>  minLevel_{LogLevel::Info};
+
+    std::atomic<bool>      started_{false};
+    std::atomic<bool>      stop_{false};
+    std::atomic<uint64_t>  dropped_{0};
+    std::thread            flusher_;
+};
+
+extern AsyncLogger logger;
+
+// Event-channel shorthands
+void logDebug(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+void logInfo (const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+void logWarn (const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+void logError(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
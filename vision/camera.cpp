@@ -0,0 +1,36 @@
+#include "camera.hpp"
+
+// ============================================================
+// CAMERA CONTEXT
+// ============================================================
+
+void initCamera(CameraContext& cam, int index, const CameraSpec& spec, int divider)
+{
+    cam.index = index;
+    cam.id    = spec.id;
+    cam.name  = spec.name;
+
+    cam.K = (cv::Mat1d(3, 3) <<
+        spec.fx / divider, 0.0,  spec.cx / divider,
+        0.0, spec.fy / divider,  spec.cy / divider,
+        0.0, 0.0, 1.0);
+
+    cam.D = (cv::Mat1d(1, 5) <<
+        spec.dist[0], spec.dist[1], spec.dist[2], spec.dist[3], spec.dist[4]);
+}
+
+std::string cameraPipeline(const CameraContext& cam, int width, int height)
+{
+    std::string src = "libcamerasrc";
+    if (!cam.name.empty())
+        src += " camera-name=\"" + cam.name + "\"";
+
+    return
+        src + " ! "
+        "video/x-raw,width=" + std::to_string(width) +
+        ",height="           + std::to_string(height) +
+        ",format=BGRx ! "
+        "videoconvert ! "
+        "video/x-raw,format=BGR ! "
+        "appsink name=sink max-buffers=1 drop=true";
+}
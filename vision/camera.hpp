@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#include <gst/gst.h>
+
+#include "tag_registry.hpp"
+
+// ============================================================
+// CAMERA CONTEXT
+//
+// One capture + detection pipeline.  Intrinsics, the camera -> world
+// calibration and the latest frame are per camera so several CSI
+// cameras can run side by side against the shared calibration tags.
+// ============================================================
+
+constexpr int SENSOR_W = 4056;
+constexpr int SENSOR_H = 3040;
+
+struct CameraSpec
+{
+    const char* id;           // reported as camera_id
+    const char* name;         // libcamerasrc camera-name, "" = first camera found
+    double fx, fy, cx, cy;    // full-resolution intrinsics (SENSOR_W x SENSOR_H)
+    double dist[5];           // k1 k2 p1 p2 k3
+};
+
+// ============================================================
+// CAMERAS
+//
+// One entry per CSI camera; the first `cameras` (config) are opened.
+// Each camera calibrates itself against tags 2-5, so all of them report
+// in the same world frame.  camera-name strings come from
+// `libcamera-hello --list-cameras`; "" picks the first camera found.
+// Intrinsics are full-resolution values (divided by resolution_divider).
+// param_sweep and ProductionRig (production_rig.hpp) read cam0's.
+// ============================================================
+
+inline constexpr CameraSpec CAMERA_SPECS[] =
+{
+    { "cam0", "",
+      4009.22661, 4020.48344, 2113.49677, 1469.08894,
+      { -0.49, 0.28, 0.0, 0.0, -0.09 } },
+
+    // Second CSI port on the Pi 5.  Placeholder intrinsics copied from
+    // cam0 -- run calib_intrinsics.py for this lens before enabling.
+    { "cam1", "/base/axi/pcie@120000/rp1/i2c@80000/imx477@1a",
+      4009.22661, 4020.48344, 2113.49677, 1469.08894,
+      { -0.49, 0.28, 0.0, 0.0, -0.09 } },
+};
+
+struct CameraContext
+{
+    int         index = 0;
+    std::string id;
+    std::string name;
+
+    GstElement* pipe = nullptr;
+    GstElement* sink = nullptr;
+
+    cv::Mat K;
+    cv::Mat D;
+
+    // Camera -> world transform
+    cv::Mat R_wc;
+    cv::Mat t_wc;
+    std::atomic<bool> calibrated{false};
+
+    std::mutex              frameMutex;
+    std::condition_variable frameReady;      // signalled when latestSeq advances
+    cv::Mat                 latestFrame;
+    uint64_t                latestSeq   = 0;
+    double                  latestStamp = 0.0;   // steady clock, seconds, at capture
+    double                  latestUnix  = 0.0;   // wall clock, seconds, at capture
+    double                  latestHandoff = 0.0; // steady clock, when handed to tracking
+
+    uint64_t                captureSeq  = 0;     // producer only: last sequence captured
+
+    // Last sequence the tracking thread finished with (replay lockstep)
+    std::atomic<uint64_t>   processedSeq{0};
+
+    // Tags accepted from this camera's last frame (guarded by poseMutex)
+    TrackSet   observed;
+
+    // Control channel: set to redo calibration; the tracking thread clears
+    // it and acknowledges each ControlState generation between frames
+    std::atomic<bool>       recalibrate{false};
+    std::atomic<uint64_t>   controlSeen{0};
+};
+
+// Fill intrinsics from spec, scaled to the capture resolution.
+void initCamera(CameraContext& cam, int index, const CameraSpec& spec, int divider);
+
+// GStreamer launch string for this camera's capture pipeline.
+std::string cameraPipeline(const CameraContext& cam, int width, int height);
@@ -0,0 +1,236 @@
+#include "clip_buffer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "async_logger.hpp"
+
+// ============================================================
+// CLIP BUFFER
+// ============================================================
+
+const char* clipTriggerName(ClipTrigger why)
+{
+    switch (why)
+    {
+        case ClipTrigger::ConfidenceDrop: return "conf_drop";
+        case ClipTrigger::JumpRejected:   return "jump";
+        case ClipTrigger::TagLost:        return "tag_lost";
+        case ClipTrigger::External:       return "external";
+    }
+    return "unknown";
+}
+
+ClipBuffer::~ClipBuffer()
+{
+    close();
+}
+
+bool ClipBuffer::open(const std::string& dir, int width, int height, int channels,
+                      size_t capacity, size_t postFrames, const std::vector<int>& tagIds)
+{
+    close();
+
+    dir_        = dir;
+    width_      = width;
+    height_     = height;
+    channels_   = channels;
+    recordSize_ = frameRecordSize(width, height, channels);
+    postFrames_ = std::min(postFrames, capacity / 2);
+    tagIds_     = tagIds;
+
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        void* p = nullptr;
+        if (posix_memalign(&p, FRAME_FILE_ALIGN, recordSize_) != 0)
+        {
+            logError("Clip buffer: out of memory after %zu frames", i);
+            close();
+            return false;
+        }
+        std::memset(p, 0, recordSize_);
+        slots_.push_back(static_cast<uint8_t*>(p));
+    }
+
+    states_.assign(capacity, TrackSet{});
+    for (auto& s : states_) s.resize(tagIds.size());
+    slotState_.assign(capacity, Empty);
+    saveOrder_.reserve(capacity);
+    head_  = 0;
+    count_ = 0;
+
+    stop_   = false;
+    armed_  = false;
+    saving_ = false;
+    saver_  = std::thread(&ClipBuffer::saverLoop, this);
+
+    logInfo("Clip buffer: %zu frames (%zu MiB) -> %s",
+            capacity, (capacity * recordSize_) >> 20, dir.c_str());
+    return true;
+}
+
+void ClipBuffer::close()
+{
+    if (saver_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        saver_.join();
+    }
+
+    for (uint8_t* p : slots_) std::free(p);
+    slots_.clear();
+    states_.clear();
+    slotState_.clear();
+    saveOrder_.clear();
+}
+
+void ClipBuffer::push(const FrameRecordHeader& meta, const cv::Mat& img, const TrackSet& state)
+{
+    if (slots_.empty() || img.cols != width_ || img.rows != height_ ||
+        img.channels() != channels_)
+        return;
+
+    size_t slot;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot = head_;
+        if (slotState_[slot] == Saving || slotState_[slot] == Writing) return;
+        slotState_[slot] = Writing;
+        head_  = (head_ + 1) % slots_.size();
+        count_ = std::min(count_ + 1, slots_.size());
+    }
+
+    uint8_t* dst = slots_[slot];
+    std::memcpy(dst, &meta, sizeof(meta));
+
+    const size_t rowBytes = size_t(width_) * channels_;
+    uint8_t* pixels = dst + FRAME_RECORD_HEADER;
+    for (int r = 0; r < height_; ++r)
+        std::memcpy(pixels + r * rowBytes, img.ptr(r), rowBytes);
+
+    states_[slot] = state;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slotState_[slot] = Ready;
+        if (armed_ && postLeft_ > 0 && --postLeft_ == 0)
+            scheduleSaveLocked();
+    }
+}
+
+void ClipBuffer::trigger(ClipTrigger why)
+{
+    if (slots_.empty()) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (armed_ || saving_) return;
+
+    armed_    = true;
+    reason_   = why;
+    postLeft_ = postFrames_;
+    if (postLeft_ == 0) scheduleSaveLocked();
+}
+
+void ClipBuffer::scheduleSaveLocked()
+{
+    // Oldest filled slot is head_ once the ring has wrapped, else slot 0.
+    saveOrder_.clear();
+    const size_t n     = slots_.size();
+    const size_t start = count_ == n ? head_ : 0;
+    for (size_t i = 0; i < count_; ++i)
+    {
+        const size_t s = (start + i) % n;
+        if (slotState_[s] != Ready) continue;
+        slotState_[s] = Saving;
+        saveOrder_.push_back(s);
+    }
+
+    armed_  = false;
+    saving_ = true;
+    wake_.notify_one();
+}
+
+void ClipBuffer::saverLoop()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stop_ || saving_; });
+            if (!saving_) return;
+        }
+
+        saveClip();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        saving_ = false;
+    }
+}
+
+void ClipBuffer::saveClip()
+{
+    const auto now = std::chrono::system_clock::now();
+    const long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()).count();
+    const std::string base =
+        dir_ + "/clip_" + std::to_string(ms) + "_" + clipTriggerName(reason_);
+
+    const std::string framesPath = base + ".frames";
+    int fd = ::open(framesPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        logError("Cannot create clip %s", framesPath.c_str());
+    }
+
+    std::ofstream csv(base + ".csv");
+    csv << "frame_id,seq,stamp,camera,tag,x,y,yaw,conf,visible\n";
+    csv << std::fixed;
+
+    uint64_t written = 0;
+    for (size_t slot : saveOrder_)
+    {
+        const auto& meta = *reinterpret_cast<const FrameRecordHeader*>(slots_[slot]);
+
+        if (fd >= 0)
+        {
+            const off_t offset = FRAME_FILE_ALIGN + off_t(written) * off_t(recordSize_);
+            if (pwrite(fd, slots_[slot], recordSize_, offset) == static_cast<ssize_t>(recordSize_))
+                ++written;
+        }
+
+        const TrackSet& ts = states_[slot];
+        for (size_t k = 0; k < ts.size(); ++k)
+        {
+            csv << meta.frameId << "," << meta.seq << ","
+                << std::setprecision(6) << meta.stamp << "," << meta.camera << ","
+                << tagIds_[k] << ","
+                << std::setprecision(4) << ts.pose[k].x << "," << ts.pose[k].y << ","
+                << ts.pose[k].yaw << ","
+                << std::setprecision(3) << ts.confidence[k] << ","
+                << int(ts.visible[k]) << "\n";
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        slotState_[slot] = Ready;
+    }
+
+    if (fd >= 0)
+    {
+        writeFrameFileHeader(fd, width_, height_, channels_, written);
+        ::close(fd);
+    }
+
+    logInfo("Clip saved (%s): %llu frames -> %s", clipTriggerName(reason_),
+            static_cast<unsigned long long>(written), framesPath.c_str());
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "frame_file.hpp"
+#include "tag_registry.hpp"
+
+// ============================================================
+// CLIP BUFFER
+//
+// RAM ring of the most recent frames and tracking states.  Nothing is
+// written until trigger() is called; then, once `postFrames` more frames
+// have arrived, the ring contents are handed to a background thread that
+// saves them as a frame file (replayable with --replay) plus a CSV of the
+// per-frame tag states.  Each ring slot is laid out as a frame-file
+// record, so saving is one write per frame and no copy.
+//
+// While a clip is being saved its slots are locked: new frames that land
+// on a locked slot are skipped rather than waited for.
+// ============================================================
+
+enum class ClipTrigger : uint8_t
+{
+    ConfidenceDrop,
+    JumpRejected,
+    TagLost,
+    External,
+};
+
+const char* clipTriggerName(ClipTrigger why);
+
+class ClipBuffer
+{
+public:
+    ClipBuffer() = default;
+    ~ClipBuffer();
+
+    ClipBuffer(const ClipBuffer&)            = delete;
+    ClipBuffer& operator=(const ClipBuffer&) = delete;
+
+    bool open(const std::string& dir, int width, int height, int channels,
+              size_t capacity, size_t postFrames, const std::vector<int>& tagIds);
+    void close();
+
+    bool enabled() const { return !slots_.empty(); }
+
+    void push(const FrameRecordHeader& meta, const cv::Mat& img, const TrackSet& state);
+
+    // Thread-safe and non-blocking; ignored while a clip is pending.
+    void trigger(ClipTrigger why);
+
+private:
+    enum SlotState : uint8_t { Empty, Writing, Ready, Saving };
+
+    void scheduleSaveLocked();
+    void saverLoop();
+    void saveClip();
+
+    std::string dir_;
+    int         width_      = 0;
+    int         height_     = 0;
+    int         channels_   = 0;
+    size_t      recordSize_ = 0;
+    size_t      postFrames_ = 0;
+    std::vector<int> tagIds_;
+
+    // Ring storage, indexed by slot
+    std::vector<uint8_t*>  slots_;
+    std::vector<TrackSet>  states_;
+    std::vector<SlotState> slotState_;
+    size_t                 head_  = 0;   // next slot to write
+    size_t                 count_ = 0;   // filled slots
+
+    // Trigger / save state, guarded by mutex_
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    bool                    armed_       = false;
+    bool                    saving_      = false;
+    bool                    stop_        = false;
+    size_t                  postLeft_    = 0;
+    ClipTrigger             reason_      = ClipTrigger::External;
+    std::vector<size_t>     saveOrder_;  // oldest -> newest
+    std::thread             saver_;
+};
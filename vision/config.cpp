@@ -0,0 +1,205 @@
+#include "config.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include "async_logger.hpp"
+#include "camera.hpp"
+
+// ============================================================
+// PROFILES
+//
+// From the Performance Tips in README.md; check them on the Pi with
+// param_sweep before relying on the numbers.
+// ============================================================
+
+struct Profile
+{
+    const char* name;
+    std::vector<std::pair<const char*, const char*>> settings;   // on top of the defaults
+};
+
+static const Profile PROFILES[] =
+{
+    { "default", {} },
+
+    // 1014 x 760, full-resolution quad search: highest frame rate
+    { "fast",    { { "resolution_divider", "4" }, { "quad_decimate", "1.0" } } },
+
+    // 4056 x 3040, full-resolution quad search: lowest pose noise
+    { "precise", { { "resolution_divider", "1" }, { "quad_decimate", "1.0" } } },
+};
+
+// ============================================================
+// KEYS
+// ============================================================
+
+static bool parseDouble(const std::string& s, double lo, double hi, double& out)
+{
+    char* end;
+    errno = 0;
+    const double v = std::strtod(s.c_str(), &end);
+    if (s.empty() || *end != '\0' || errno != 0 || v < lo || v > hi) return false;
+    out = v;
+    return true;
+}
+
+static bool parseInt(const std::string& s, int lo, int hi, int& out)
+{
+    double v;
+    if (!parseDouble(s, lo, hi, v) || v != static_cast<int>(v)) return false;
+    out = static_cast<int>(v);
+    return true;
+}
+
+struct ConfigKey
+{
+    const char* name;
+    bool (*set)(TrackerConfig& cfg, const std::string& value);
+};
+
+static const ConfigKey CONFIG_KEYS[] =
+{
+    { "resolution_divider", [](TrackerConfig& c, const std::string& v)
+        {
+            int d;
+            if (!parseInt(v, 1, 4, d) || SENSOR_W % d != 0 || SENSOR_H % d != 0) return false;
+            c.resolutionDivider = d;
+            return true;
+        } },
+    { "cameras",            [](TrackerConfig& c, const std::string& v) { return parseInt(v, 1, 8, c.cameras); } },
+    { "tag_size",           [](TrackerConfig& c, const std::string& v) { return parseDouble(v, 1e-3, 10.0, c.tagSize); } },
+    { "calib_square",       [](TrackerConfig& c, const std::string& v) { return parseDouble(v, 1e-3, 100.0, c.calibSquare); } },
+    { "quad_decimate",      [](TrackerConfig& c, const std::string& v) { return parseDouble(v, 1.0, 8.0, c.detector.quadDecimate); } },
+    { "detector_threads",   [](TrackerConfig& c, const std::string& v) { return parseInt(v, 1, 64, c.detector.nthreads); } },
+    { "refine_edges",       [](TrackerConfig& c, const std::string& v)
+        {
+            int r;
+            if (!parseInt(v, 0, 1, r)) return false;
+            c.detector.refineEdges = r != 0;
+            return true;
+        } },
+    { "roi",                [](TrackerConfig& c, const std::string& v)
+        {
+            int r;
+            if (!parseInt(v, 0, 1, r)) return false;
+            c.roi = r != 0;
+            return true;
+        } },
+    { "min_track_conf",     [](TrackerConfig& c, const std::string& v) { return parseDouble(v, 0.0, 1.0, c.minTrackConf); } },
+    { "max_track_jump",     [](TrackerConfig& c, const std::string& v) { return parseDouble(v, 0.0, 100.0, c.maxTrackJumpM); } },
+    { "pose_cache_px",      [](TrackerConfig& c, const std::string& v) { return parseDouble(v, 0.0, 10.0, c.poseCachePx); } },
+    { "orbit_model",        [](TrackerConfig& c, const std::string& v)
+        {
+            int r;
+            if (!parseInt(v, 0, 1, r)) return false;
+            c.orbitModel = r != 0;
+            return true;
+        } },
+    { "fusion_window",      [](TrackerConfig& c, const std::string& v) { return parseDouble(v, 0.0, 10.0, c.fusionWindowS); } },
+    { "clip_trigger_conf",  [](TrackerConfig& c, const std::string& v) { return parseDouble(v, 0.0, 1.0, c.clipTriggerConf); } },
+    { "bridge",             [](TrackerConfig& c, const std::string& v) { c.bridge = v; return true; } },
+};
+
+static const ConfigKey* findKey(const std::string& key)
+{
+    for (const auto& k : CONFIG_KEYS)
+        if (key == k.name) return &k;
+    return nullptr;
+}
+
+// ============================================================
+// CONFIG
+// ============================================================
+
+bool applyProfile(TrackerConfig& cfg, const std::string& name)
+{
+    for (const auto& p : PROFILES)
+    {
+        if (name != p.name) continue;
+        cfg = TrackerConfig{};
+        cfg.profile = p.name;
+        for (const auto& kv : p.settings)
+            setConfigValue(cfg, kv.first, kv.second);
+        return true;
+    }
+    logError("Unknown profile '%s' (default, fast, precise)", name.c_str());
+    return false;
+}
+
+bool isConfigKey(const std::string& key)
+{
+    return findKey(key) != nullptr;
+}
+
+bool setConfigValue(TrackerConfig& cfg, const std::string& key, const std::string& value)
+{
+    const ConfigKey* k = findKey(key);
+    if (!k)
+    {
+        logError("Unknown setting '%s'", key.c_str());
+        return false;
+    }
+    if (!k->set(cfg, value))
+    {
+        logError("Invalid value for %s: '%s'", key.c_str(), value.c_str());
+        return false;
+    }
+    return true;
+}
+
+static std::string trim(const std::string& s)
+{
+    const size_t b = s.find_first_not_of(" \t\r");
+    if (b == std::string::npos) return "";
+    const size_t e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+bool loadConfigFile(TrackerConfig& cfg, const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        logError("Cannot open config file %s", path.c_str());
+        return false;
+    }
+
+    std::string line;
+    for (int n = 1; std::getline(in, line); ++n)
+    {
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        line = trim(line);
+        if (line.empty()) continue;
+
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos)
+        {
+            logError("%s:%d: expected 'name = value'", path.c_str(), n);
+            return false;
+        }
+        if (!setConfigValue(cfg, trim(line.substr(0, eq)), trim(line.substr(eq + 1))))
+        {
+            logError("%s:%d: rejected", path.c_str(), n);
+            return false;
+        }
+    }
+    return true;
+}
+
+void logConfig(const TrackerConfig& cfg)
+{
+    logInfo("Config (%s): %dx%d (divider %d), %d camera(s), tag %.4f m, calib square %.3f m, "
+            "quad_decimate %.2f, %d detector threads, refine_edges %d, roi %d, min conf %.2f, "
+            "max jump %.3f m, pose cache %.2f px, orbit model %d, fusion %.3f s, bridge %s",
+            cfg.profile.c_str(), SENSOR_W / cfg.resolutionDivider, SENSOR_H / cfg.resolutionDivider,
+            cfg.resolutionDivider, cfg.cameras, cfg.tagSize, cfg.calibSquare,
+            cfg.detector.quadDecimate, cfg.detector.nthreads, cfg.detector.refineEdges ? 1 : 0, cfg.roi ? 1 : 0,
+            cfg.minTrackConf, cfg.maxTrackJumpM, cfg.poseCachePx, cfg.orbitModel ? 1 : 0,
+            cfg.fusionWindowS,
+            cfg.bridge.empty() ? "off" : cfg.bridge.c_str());
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+
+#include "tag_detector.hpp"
+
+// ============================================================
+// TRACKER CONFIG
+//
+// Settings chosen at startup rather than compiled in.  Later sources
+// override earlier ones: built-in defaults, a --profile preset, a
+// --config file, then individual flags.  Every setting has one name,
+// written `name = value` in the file and `--name value` on the command
+// line (underscores become dashes):
+//
+//   resolution_divider  1, 2 or 4; capture size and intrinsics scale by it
+//   cameras             CSI cameras opened (CAMERA_SPECS order)
+//   tag_size            metres, black border edge of every tag
+//   calib_square        metres, corner-0 spacing of calibration tags 2-5
+//   quad_decimate       AprilTag quad_decimate
+//   detector_threads    AprilTag nthreads
+//   refine_edges        0 / 1
+//   roi                 0 / 1, detect only around last frame's tracked tags
+//   min_track_conf      reject sightings below this confidence
+//   max_track_jump      metres, reject larger frame-to-frame jumps
+//   pose_cache_px       pixels; reuse a tag's last pose while no corner
+//                       has moved further since it was solved (0 = off)
+//   orbit_model         0 / 1, gate and place the end mass's ROI from the
+//                       orbit model's prediction (orbit_model.hpp)
+//   fusion_window       seconds, cross-camera sighting window
+//   clip_trigger_conf   --clip-dir saves a clip below this confidence
+//   bridge              bridge subscriber spec (publisher.hpp), "" = none
+// ============================================================
+
+struct TrackerConfig
+{
+    std::string      profile           = "default";
+    int              resolutionDivider = 2;
+    int              cameras           = 1;
+    double           tagSize           = 0.056;
+    double           calibSquare       = 0.70;
+    DetectorSettings detector;
+    bool             roi               = false;
+    double           minTrackConf      = 0.45;
+    double           maxTrackJumpM     = 0.20;
+    double           poseCachePx       = 0.25;
+    bool             orbitModel        = true;
+    double           fusionWindowS     = 0.05;
+    double           clipTriggerConf   = 0.60;
+    std::string      bridge            = "udp://127.0.0.1:9001";
+};
+
+// Presets: "default", "fast", "precise".  Resets every setting first.
+bool applyProfile(TrackerConfig& cfg, const std::string& name);
+
+// `key` uses underscores.  Logs and returns false on an unknown key or
+// an out-of-range value.
+bool isConfigKey(const std::string& key);
+bool setConfigValue(TrackerConfig& cfg, const std::string& key, const std::string& value);
+
+// `key = value` lines; blank lines and '#' comments are skipped.
+bool loadConfigFile(TrackerConfig& cfg, const std::string& path);
+
+// One [INFO] line with the effective settings
+void logConfig(const TrackerConfig& cfg);
@@ -0,0 +1,353 @@
+// ============================================================
+// contract_loadgen — detector-contract load generator
+//
+// Sends synthetic detector output through the tracker's own Publisher
+// (so datagrams are byte-identical to apriltag_demo's) and, optionally,
+// listens on the bridge's WebSocket to measure end-to-end latency.
+//
+//   contract_loadgen --rate 500 --duration 10
+//   contract_loadgen --rate 2000 --format binary --loss 0.02
+//   contract_loadgen --rate 1000 --burst 5:100 --tags 6 --ws 127.0.0.1:8080
+//
+// Options:
+//   --target <spec>      publisher spec        (udp://127.0.0.1:9001)
+//   --format json|binary detector contract or packed binary (json)
+//   --rate <hz>          datagrams per second  (500)
+//   --duration <s>       run time              (10)
+//   --radius <m>         end-mass orbit radius (0.3)
+//   --omega <rad/s>      orbit angular rate    (10; radius * omega * 1 ms
+//                        must exceed the bridge's 2 mm stationary deadband)
+//   --tags <n>           tracked tags, >= 2    (2)
+//   --loss <p>           drop each frame with probability p
+//   --burst <n>:<every>  drop n consecutive frames every <every>
+//   --ws <host:port>     measure latency on this WebSocket ("" = off)
+//
+// Timestamps advance exactly 1 ms per frame regardless of --rate, so the
+// GUI payload's millisecond timestamp identifies the frame it came from.
+// cpp_stream_bridge.py accepts both formats.
+// ============================================================
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "async_logger.hpp"
+#include "publisher.hpp"
+
+constexpr double FRAME_STEP_S = 0.001;   // synthetic capture clock
+
+static int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ============================================================
+// WEBSOCKET LATENCY PROBE
+// ============================================================
+
+struct LatencyProbe
+{
+    std::string host = "127.0.0.1";
+    int         port = 8080;
+    double      baseUnix = 0.0;
+
+    // Send time per frame (ns, 0 = not sent), written by the sender
+    std::unique_ptr<std::atomic<int64_t>[]> sentAt;
+    size_t                                   frames = 0;
+
+    std::vector<double>   latencyMs;   // probe thread only
+    std::atomic<uint64_t> received{0};
+    std::atomic<bool>     stop{false};
+    bool                  connected = false;
+};
+
+static int wsConnect(const std::string& host, int port)
+{
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1 ||
+        connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    const std::string req =
+        "GET / HTTP/1.1\r\n"
+        "Host: " + host + ":" + std::to_string(port) + "\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Key: bG9hZGdlbi1wcm9iZS0wMQ==\r\n"
+        "Sec-WebSocket-Version: 13\r\n\r\n";
+    if (send(fd, req.data(), req.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(req.size()))
+    {
+        close(fd);
+        return -1;
+    }
+
+    // Read up to the end of the response headers, one byte at a time so no
+    // frame bytes are consumed.
+    std::string resp;
+    char c;
+    while (resp.find("\r\n\r\n") == std::string::npos && resp.size() < 4096)
+    {
+        if (recv(fd, &c, 1, 0) != 1) { close(fd); return -1; }
+        resp += c;
+    }
+    if (resp.compare(0, 12, "HTTP/1.1 101") != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    timeval tv{0, 200000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+static void probeThread(LatencyProbe* probe, int fd)
+{
+    std::string buf;
+    char chunk[65536];
+
+    while (!probe->stop)
+    {
+        const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n == 0) break;
+        if (n < 0) continue;   // timeout: re-check stop
+        const int64_t arrived = nowNs();
+        buf.append(chunk, static_cast<size_t>(n));
+
+        // Server frames are unmasked
+        for (;;)
+        {
+            if (buf.size() < 2) break;
+            const auto* p = reinterpret_cast<const uint8_t*>(buf.data());
+            uint64_t len  = p[1] & 0x7F;
+            size_t   head = 2;
+            if (len == 126)
+            {
+                if (buf.size() < 4) break;
+                len = (uint64_t(p[2]) << 8) | p[3];
+                head = 4;
+            }
+            else if (len == 127)
+            {
+                if (buf.size() < 10) break;
+                len = 0;
+                for (int i = 0; i < 8; ++i) len = (len << 8) | p[2 + i];
+                head = 10;
+            }
+            if (buf.size() < head + len) break;
+
+            if ((p[0] & 0x0F) == 0x1)
+            {
+                const std::string text = buf.substr(head, len);
+                const size_t at = text.find("\"timestamp\":");
+                if (at != std::string::npos)
+                {
+                    const long long ms    = std::atoll(text.c_str() + at + 12);
+                    const long long frame = ms - static_cast<long long>(probe->baseUnix) * 1000;
+                    if (frame >= 0 && static_cast<size_t>(frame) < probe->frames)
+                    {
+                        const int64_t sent = probe->sentAt[frame].load(std::memory_order_acquire);
+                        if (sent > 0)
+                            probe->latencyMs.push_back((arrived - sent) / 1e6);
+                    }
+                }
+                ++probe->received;
+            }
+            buf.erase(0, head + len);
+        }
+    }
+    close(fd);
+}
+
+static double percentile(std::vector<double> v, double q)
+{
+    if (v.empty()) return 0.0;
+    const size_t i = std::min(v.size() - 1, static_cast<size_t>(q * (v.size() - 1) + 0.5));
+    std::nth_element(v.begin(), v.begin() + i, v.end());
+    return v[i];
+}
+
+// ============================================================
+// MAIN
+// ============================================================
+
+int main(int argc, char** argv)
+{
+    std::string target = "udp://127.0.0.1:9001";
+    std::string format = "json";
+    std::string ws;
+    double rate = 500.0, duration = 10.0, radius = 0.3, omega = 10.0, loss = 0.0;
+    int    tagCount = 2, burstLen = 0, burstEvery = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if      (arg == "--target"   && i + 1 < argc) target   = argv[++i];
+        else if (arg == "--format"   && i + 1 < argc) format   = argv[++i];
+        else if (arg == "--rate"     && i + 1 < argc) rate     = std::atof(argv[++i]);
+        else if (arg == "--duration" && i + 1 < argc) duration = std::atof(argv[++i]);
+        else if (arg == "--radius"   && i + 1 < argc) radius   = std::atof(argv[++i]);
+        else if (arg == "--omega"    && i + 1 < argc) omega    = std::atof(argv[++i]);
+        else if (arg == "--tags"     && i + 1 < argc) tagCount = std::max(2, std::atoi(argv[++i]));
+        else if (arg == "--loss"     && i + 1 < argc) loss     = std::atof(argv[++i]);
+        else if (arg == "--ws"       && i + 1 < argc) ws       = argv[++i];
+        else if (arg == "--burst"    && i + 1 < argc)
+        {
+            if (std::sscanf(argv[++i], "%d:%d", &burstLen, &burstEvery) != 2)
+                burstLen = burstEvery = 0;
+        }
+        else
+        {
+            std::fprintf(stderr, "unknown option %s (see contract_loadgen.cpp)\n", arg.c_str());
+            return 2;
+        }
+    }
+    if (rate <= 0.0 || duration <= 0.0) return 2;
+
+    const std::string spec = target + (target.find('?') == std::string::npos ? "?" : "&") +
+                             (format == "binary" ? "format=binary" : "format=contract");
+
+    Publisher publisher;
+    if (!publisher.addSubscriber(spec)) return 1;
+
+    std::vector<int> tagIds;
+    for (int i = 0; i < tagCount; ++i) tagIds.push_back(i);
+    publisher.start(tagIds, 0, 1, { "loadgen" }, 1024);
+
+    const size_t frames = static_cast<size_t>(rate * duration);
+    const double baseUnix = std::floor(std::chrono::duration<double>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    LatencyProbe probe;
+    probe.baseUnix = baseUnix;
+    probe.frames   = frames;
+    probe.sentAt.reset(new std::atomic<int64_t>[frames]);
+    for (size_t i = 0; i < frames; ++i) probe.sentAt[i].store(0, std::memory_order_relaxed);
+
+    std::thread probeWorker;
+    if (!ws.empty())
+    {
+        const size_t colon = ws.rfind(':');
+        if (colon != std::string::npos)
+        {
+            probe.host = ws.substr(0, colon);
+            probe.port = std::atoi(ws.c_str() + colon + 1);
+        }
+        const int fd = wsConnect(probe.host, probe.port);
+        if (fd < 0)
+        {
+            std::fprintf(stderr, "cannot open WebSocket %s; latency not measured\n", ws.c_str());
+        }
+        else
+        {
+            probe.connected = true;
+            probeWorker = std::thread(probeThread, &probe, fd);
+        }
+    }
+
+    TrackSet ts;
+    ts.resize(tagIds.size());
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    const auto period = std::chrono::duration<double>(1.0 / rate);
+    const auto start  = std::chrono::steady_clock::now();
+    uint64_t sent = 0, lost = 0, late = 0;
+
+    for (size_t f = 0; f < frames; ++f)
+    {
+        const auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(period * double(f));
+        if (std::chrono::steady_clock::now() > due + period) ++late;
+        std::this_thread::sleep_until(due);
+
+        const bool burst = burstEvery > 0 && static_cast<int>(f % burstEvery) < burstLen;
+        if (burst || (loss > 0.0 && uni(rng) < loss))
+        {
+            ++lost;
+            continue;
+        }
+
+        // Satellite drifts slowly; end masses orbit it at increasing radii
+        const double t = f * FRAME_STEP_S;
+        ts.pose[0] = { 0.05 * std::sin(0.1 * t), 0.05 * std::cos(0.1 * t), 0.0 };
+        for (size_t k = 1; k < ts.size(); ++k)
+        {
+            const double a = omega * t + 0.5 * (k - 1);
+            const double r = radius * (1.0 + 0.1 * (k - 1));
+            ts.pose[k] = { ts.pose[0].x + r * std::cos(a), ts.pose[0].y + r * std::sin(a), a };
+        }
+        for (size_t k = 0; k < ts.size(); ++k)
+        {
+            ts.confidence[k] = 0.9;
+            ts.visible[k]    = 1;
+        }
+
+        probe.sentAt[f].store(nowNs(), std::memory_order_release);
+        // Mid-step stamp so the bridge's int(ts * 1000) lands on frame f
+        if (publisher.post(f, baseUnix + t + 0.5 * FRAME_STEP_S, 0, ts)) ++sent;
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    publisher.stop();
+
+    if (probeWorker.joinable())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));   // drain the bridge
+        probe.stop = true;
+        probeWorker.join();
+    }
+
+    std::printf("format      %s\n", format.c_str());
+    std::printf("target      %s\n", target.c_str());
+    std::printf("rate        %.0f Hz requested, %.0f Hz achieved\n", rate, (sent + lost) / elapsed);
+    std::printf("frames      %zu scheduled, %llu sent, %llu dropped by pattern, %llu queue drops\n",
+                frames, static_cast<unsigned long long>(sent), static_cast<unsigned long long>(lost),
+                static_cast<unsigned long long>(publisher.dropped()));
+    std::printf("late        %llu frames sent more than one period late\n",
+                static_cast<unsigned long long>(late));
+
+    if (probe.connected)
+    {
+        const auto& l = probe.latencyMs;
+        std::printf("ws          %llu payloads received (%.1f%% of sent)\n",
+                    static_cast<unsigned long long>(probe.received.load()),
+                    sent ? 100.0 * probe.received / sent : 0.0);
+        std::printf("latency ms  p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n",
+                    percentile(l, 0.50), percentile(l, 0.90), percentile(l, 0.99),
+                    l.empty() ? 0.0 : *std::max_element(l.begin(), l.end()));
+
+        // Latency growing across the run means the bridge is falling behind
+        if (l.size() >= 20)
+        {
+            const size_t tenth = l.size() / 10;
+            const std::vector<double> head(l.begin(), l.begin() + tenth);
+            const std::vector<double> tail(l.end() - tenth, l.end());
+            std::printf("lag trend   first 10%% p50 %.2f ms, last 10%% p50 %.2f ms\n",
+                        percentile(head, 0.5), percentile(tail, 0.5));
+        }
+    }
+    return 0;
+}
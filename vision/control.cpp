@@ -0,0 +1,135 @@
+#include "control.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "async_logger.hpp"
+
+constexpr size_t CONTROL_MAX_COMMAND = 1024;
+constexpr size_t CONTROL_MAX_REPLY   = 60000;   // fits one UDP datagram
+
+// ============================================================
+// CONTROL SERVER
+// ============================================================
+
+ControlServer::~ControlServer()
+{
+    stop();
+}
+
+bool ControlServer::start(const std::string& spec, Handler handler)
+{
+    stop();
+
+    sockaddr_storage addr{};
+    socklen_t        addrLen = 0;
+
+    if (spec.compare(0, 6, "udp://") == 0)
+    {
+        const std::string hostPort = spec.substr(6);
+        const size_t colon = hostPort.rfind(':');
+        auto* in = reinterpret_cast<sockaddr_in*>(&addr);
+        in->sin_family = AF_INET;
+        if (colon == std::string::npos ||
+            inet_pton(AF_INET, hostPort.substr(0, colon).c_str(), &in->sin_addr) != 1)
+        {
+            logError("Control %s: expected udp://<ipv4>:<port>", spec.c_str());
+            return false;
+        }
+        in->sin_port = htons(static_cast<uint16_t>(std::atoi(hostPort.c_str() + colon + 1)));
+        addrLen = sizeof(sockaddr_in);
+        fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    }
+    else if (spec.compare(0, 7, "unix://") == 0)
+    {
+        const std::string path = spec.substr(7);
+        auto* un = reinterpret_cast<sockaddr_un*>(&addr);
+        if (path.empty() || path.size() >= sizeof(un->sun_path))
+        {
+            logError("Control %s: bad socket path", spec.c_str());
+            return false;
+        }
+        un->sun_family = AF_UNIX;
+        std::memcpy(un->sun_path, path.c_str(), path.size() + 1);
+        addrLen = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() + 1);
+        unlink(path.c_str());   // stale socket from an earlier run
+        unixPath_ = path;
+        fd_ = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    }
+    else
+    {
+        logError("Control %s: expected udp:// or unix://", spec.c_str());
+        return false;
+    }
+
+    if (fd_ < 0 || bind(fd_, reinterpret_cast<const sockaddr*>(&addr), addrLen) != 0)
+    {
+        logError("Control %s: cannot bind: %s", spec.c_str(), std::strerror(errno));
+        stop();
+        return false;
+    }
+
+    timeval tv{0, 200000};
+    setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    handler_ = std::move(handler);
+    stop_    = false;
+    thread_  = std::thread(&ControlServer::serverLoop, this);
+
+    logInfo("Control channel on %s", spec.c_str());
+    return true;
+}
+
+void ControlServer::stop()
+{
+    stop_ = true;
+    if (thread_.joinable()) thread_.join();
+
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    if (!unixPath_.empty()) unlink(unixPath_.c_str());
+    unixPath_.clear();
+}
+
+void ControlServer::serverLoop()
+{
+    char buf[CONTROL_MAX_COMMAND];
+    while (!stop_)
+    {
+        sockaddr_storage from{};
+        socklen_t        fromLen = sizeof(from);
+        const ssize_t n = recvfrom(fd_, buf, sizeof(buf) - 1, 0,
+                                   reinterpret_cast<sockaddr*>(&from), &fromLen);
+        if (n <= 0) continue;
+        buf[n] = '\0';
+
+        std::vector<std::string> words;
+        std::string command;
+        std::istringstream line(buf);
+        for (std::string w; line >> w; )
+        {
+            command += (words.empty() ? "" : " ") + w;
+            words.push_back(w);
+        }
+        if (words.empty()) continue;
+
+        std::string reply = handler_(words);
+        logInfo("Control: %s -> %s", command.c_str(), reply.substr(0, reply.find('\n')).c_str());
+
+        // Unbound Unix clients have no address to answer to
+        if (fromLen <= sizeof(sa_family_t)) continue;
+        reply += '\n';
+        if (reply.size() > CONTROL_MAX_REPLY) reply.resize(CONTROL_MAX_REPLY);
+        sendto(fd_, reply.data(), reply.size(), MSG_DONTWAIT,
+               reinterpret_cast<const sockaddr*>(&from), fromLen);
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================
+// CONTROL CHANNEL  (--control <spec>)
+//
+// Local datagram socket for changing the running tracker without a
+// restart.  Each datagram is one command line; the reply is one
+// datagram back to the sender:
+//
+//   udp://127.0.0.1:9004               echo status | nc -u -w1 127.0.0.1 9004
+//   unix:///tmp/tracker-control.sock   socat - UNIX-SENDTO:/tmp/...,bind=/tmp/me
+//
+// The server only parses and replies; main.cpp's handler decides what
+// a command means.  Settings that the tracking threads use live in
+// ControlState: the handler stores them and then bumps `generation`,
+// and each tracking thread re-reads them when it sees a new generation
+// between two frames.  The hot path costs one atomic load per frame.
+// ============================================================
+
+struct ControlState
+{
+    std::atomic<uint64_t> generation{0};
+    std::atomic<bool>     roi{false};
+    std::atomic<double>   quadDecimate{2.0};
+    std::atomic<bool>     recording{false};
+};
+
+class ControlServer
+{
+public:
+    // Words of one command -> reply text ("ok ..." / "error: ...")
+    using Handler = std::function<std::string(const std::vector<std::string>& words)>;
+
+    ControlServer() = default;
+    ~ControlServer();
+
+    ControlServer(const ControlServer&)            = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+    bool start(const std::string& spec, Handler handler);
+    void stop();
+
+private:
+    void serverLoop();
+
+    int               fd_ = -1;
+    std::string       unixPath_;   // unlinked on stop
+    Handler           handler_;
+    std::atomic<bool> stop_{false};
+    std::thread       thread_;
+};
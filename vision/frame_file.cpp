@@ -0,0 +1,118 @@
+#include "frame_file.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "async_logger.hpp"
+
+// ============================================================
+// FRAME FILE HEADER
+// ============================================================
+
+bool writeFrameFileHeader(int fd, uint32_t width, uint32_t height, uint32_t channels,
+                          uint64_t frameCount)
+{
+    // O_DIRECT needs an aligned buffer and a whole-block write.
+    void* p = nullptr;
+    if (posix_memalign(&p, FRAME_FILE_ALIGN, FRAME_FILE_ALIGN) != 0) return false;
+    std::memset(p, 0, FRAME_FILE_ALIGN);
+
+    FrameFileHeader h{};
+    std::memcpy(h.magic, FRAME_FILE_MAGIC, sizeof(h.magic));
+    h.version    = FRAME_FILE_VERSION;
+    h.width      = width;
+    h.height     = height;
+    h.channels   = channels;
+    h.recordSize = frameRecordSize(width, height, channels);
+    h.frameCount = frameCount;
+    std::memcpy(p, &h, sizeof(h));
+
+    const bool ok = pwrite(fd, p, FRAME_FILE_ALIGN, 0) == static_cast<ssize_t>(FRAME_FILE_ALIGN);
+    std::free(p);
+    return ok;
+}
+
+// ============================================================
+// FRAME FILE READER
+// ============================================================
+
+FrameFileReader::~FrameFileReader()
+{
+    close();
+}
+
+bool FrameFileReader::open(const std::string& path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        logError("Cannot open frame file %s", path.c_str());
+        return false;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < FRAME_FILE_ALIGN)
+    {
+        logError("Frame file too small: %s", path.c_str());
+        ::close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+    {
+        logError("mmap failed for %s", path.c_str());
+        return false;
+    }
+
+    base_   = static_cast<uint8_t*>(p);
+    length_ = st.st_size;
+
+    const FrameFileHeader& h = header();
+    if (std::memcmp(h.magic, FRAME_FILE_MAGIC, sizeof(h.magic)) != 0 ||
+        h.version != FRAME_FILE_VERSION ||
+        h.recordSize != frameRecordSize(h.width, h.height, h.channels))
+    {
+        logError("Not a frame file (bad header): %s", path.c_str());
+        close();
+        return false;
+    }
+
+    // A recorder that did not shut down cleanly leaves frameCount at 0;
+    // every complete record is still usable.
+    const size_t onDisk = (length_ - FRAME_FILE_ALIGN) / h.recordSize;
+    count_ = h.frameCount ? std::min<size_t>(h.frameCount, onDisk) : onDisk;
+
+    madvise(base_, length_, MADV_SEQUENTIAL);
+    return true;
+}
+
+void FrameFileReader::close()
+{
+    if (base_) munmap(base_, length_);
+    base_   = nullptr;
+    length_ = 0;
+    count_  = 0;
+}
+
+const FrameRecordHeader& FrameFileReader::meta(size_t i) const
+{
+    return *reinterpret_cast<const FrameRecordHeader*>(record(i));
+}
+
+cv::Mat FrameFileReader::image(size_t i) const
+{
+    const FrameFileHeader& h = header();
+    const int type = h.channels == 1 ? CV_8UC1 : CV_8UC3;
+    return cv::Mat(h.height, h.width, type,
+                   const_cast<uint8_t*>(record(i) + FRAME_RECORD_HEADER));
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+// ============================================================
+// FRAME FILE
+//
+// Container for recorded frames.  A 4 KiB file header is followed by
+// fixed-size records, each a 64-byte record header plus the image rows
+// packed without padding, rounded up to 4 KiB.  Every record therefore
+// starts on a page boundary: the writer can use O_DIRECT and a reader can
+// mmap the file and index frame i in O(1).
+// ============================================================
+
+constexpr char     FRAME_FILE_MAGIC[8]   = { 'F','R','M','R','E','C','0','1' };
+constexpr uint32_t FRAME_FILE_VERSION    = 1;
+constexpr size_t   FRAME_FILE_ALIGN      = 4096;
+constexpr size_t   FRAME_RECORD_HEADER   = 64;
+
+struct FrameFileHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    uint64_t recordSize;    // bytes per record, multiple of FRAME_FILE_ALIGN
+    uint64_t frameCount;    // written on close; 0 means "derive from file size"
+};
+
+struct FrameRecordHeader
+{
+    uint64_t frameId;       // tracker frame id when recorded
+    uint64_t seq;           // per-camera capture sequence
+    double   stamp;         // steady clock seconds at capture
+    double   unixTime;      // wall clock seconds at capture
+    uint32_t camera;        // CameraContext::index
+    uint32_t flags;
+};
+
+static_assert(sizeof(FrameFileHeader)   <= FRAME_FILE_ALIGN,    "file header too large");
+static_assert(sizeof(FrameRecordHeader) <= FRAME_RECORD_HEADER, "record header too large");
+
+inline size_t alignUp(size_t n, size_t a)
+{
+    return (n + a - 1) / a * a;
+}
+
+inline size_t frameRecordSize(uint32_t width, uint32_t height, uint32_t channels)
+{
+    return alignUp(FRAME_RECORD_HEADER + size_t(width) * height * channels, FRAME_FILE_ALIGN);
+}
+
+// Write the file header block at offset 0 (safe on O_DIRECT descriptors).
+bool writeFrameFileHeader(int fd, uint32_t width, uint32_t height, uint32_t channels,
+                          uint64_t frameCount);
+
+// ============================================================
+// FRAME FILE READER
+//
+// Read-only mmap of a frame file.  image() returns a cv::Mat header over
+// the mapping, so replay feeds the recorded bytes to the tracker as-is.
+// ============================================================
+
+class FrameFileReader
+{
+public:
+    FrameFileReader() = default;
+    ~FrameFileReader();
+
+    FrameFileReader(const FrameFileReader&)            = delete;
+    FrameFileReader& operator=(const FrameFileReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    size_t                   size()   const { return count_; }
+    const FrameFileHeader&   header() const { return *reinterpret_cast<const FrameFileHeader*>(base_); }
+    const FrameRecordHeader& meta(size_t i) const;
+    cv::Mat                  image(size_t i) const;
+
+private:
+    const uint8_t* record(size_t i) const
+    {
+        return base_ + FRAME_FILE_ALIGN + i * header().recordSize;
+    }
+
+    uint8_t* base_   = nullptr;
+    size_t   length_ = 0;
+    size_t   count_  = 0;
+};
@@ -0,0 +1,179 @@
+#include "frame_recorder.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "async_logger.hpp"
+
+// ============================================================
+// FRAME RECORDER
+// ============================================================
+
+FrameRecorder::~FrameRecorder()
+{
+    close();
+}
+
+bool FrameRecorder::open(const std::string& path, int width, int height, int channels,
+                         size_t queueDepth)
+{
+    close();
+
+    // Prefer O_DIRECT; tmpfs and some FUSE mounts reject it.
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    direct_ = fd_ >= 0;
+    if (fd_ < 0)
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+    {
+        logError("Cannot create recording %s", path.c_str());
+        return false;
+    }
+
+    width_      = width;
+    height_     = height;
+    channels_   = channels;
+    recordSize_ = frameRecordSize(width, height, channels);
+
+    void* p = nullptr;
+    if (posix_memalign(&p, FRAME_FILE_ALIGN, recordSize_) == 0)
+    {
+        record_ = static_cast<uint8_t*>(p);
+        std::memset(record_, 0, recordSize_);
+    }
+    pending_.assign(std::max<size_t>(queueDepth, 1), Pending{});
+    for (Pending& p : pending_) p.owned.create(height, width, CV_8UC(channels));
+    pendingHead_  = 0;
+    pendingCount_ = 0;
+
+    if (!record_ || !writeFrameFileHeader(fd_, width_, height_, channels_, 0))
+    {
+        logError("Cannot initialise recording %s", path.c_str());
+        close();
+        return false;
+    }
+
+    nextRecord_ = 0;
+    written_    = 0;
+    dropped_    = 0;
+    stop_       = false;
+    writer_     = std::thread(&FrameRecorder::writerLoop, this);
+
+    logInfo("Recording %dx%dx%d frames to %s%s", width, height, channels,
+            path.c_str(), direct_ ? " (O_DIRECT)" : "");
+    return true;
+}
+
+void FrameRecorder::close()
+{
+    if (writer_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        writer_.join();
+
+        writeFrameFileHeader(fd_, width_, height_, channels_, nextRecord_);
+        logInfo("Recording closed: %llu frames, %llu dropped",
+                static_cast<unsigned long long>(written_.load()),
+                static_cast<unsigned long long>(dropped_.load()));
+    }
+
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+
+    std::free(record_);
+    record_ = nullptr;
+    pending_.clear();
+}
+
+bool FrameRecorder::push(const FrameRecordHeader& meta, const cv::Mat& img)
+{
+    return enqueue(meta, img, false);
+}
+
+bool FrameRecorder::pushCopy(const FrameRecordHeader& meta, const cv::Mat& img)
+{
+    return enqueue(meta, img, true);
+}
+
+bool FrameRecorder::enqueue(const FrameRecordHeader& meta, const cv::Mat& img, bool copy)
+{
+    if (fd_ < 0) return false;
+    if (img.cols != width_ || img.rows != height_ || img.channels() != channels_)
+    {
+        ++dropped_;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pendingCount_ == pending_.size())
+        {
+            ++dropped_;
+            return false;
+        }
+        // Not visible to the writer until counted, and several tracking
+        // threads push, so the copy is made under the lock
+        Pending& p = pending_[(pendingHead_ + pendingCount_) % pending_.size()];
+        p.meta = meta;
+        if (copy)
+        {
+            img.copyTo(p.owned);   // same size and type: no reallocation
+            p.img = p.owned;
+        }
+        else
+            p.img = img;   // reference only
+        ++pendingCount_;
+    }
+    wake_.notify_one();
+    return true;
+}
+
+void FrameRecorder::writerLoop()
+{
+    const size_t rowBytes = size_t(width_) * channels_;
+    uint8_t* pixels = record_ + FRAME_RECORD_HEADER;
+
+    while (true)
+    {
+        // The head slot stays queued while it is copied out, so
+        // pushCopy() cannot overwrite its pixels meanwhile
+        Pending* frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stop_ || pendingCount_ > 0; });
+            if (pendingCount_ == 0) return;   // stop requested and drained
+            frame = &pending_[pendingHead_];
+        }
+
+        std::memcpy(record_, &frame->meta, sizeof(frame->meta));
+        for (int r = 0; r < height_; ++r)
+            std::memcpy(pixels + r * rowBytes, frame->img.ptr(r), rowBytes);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            frame->img.release();
+            pendingHead_ = (pendingHead_ + 1) % pending_.size();
+            --pendingCount_;
+        }
+
+        const off_t offset = FRAME_FILE_ALIGN + off_t(nextRecord_) * off_t(recordSize_);
+        const ssize_t n = pwrite(fd_, record_, recordSize_, offset);
+        if (n == static_cast<ssize_t>(recordSize_))
+        {
+            ++nextRecord_;
+            ++written_;
+        }
+        else
+        {
+            ++dropped_;
+        }
+    }
+}
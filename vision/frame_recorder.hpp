@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "frame_file.hpp"
+
+// ============================================================
+// FRAME RECORDER
+//
+// Writes frames to a frame file (see frame_file.hpp) from a dedicated
+// writer thread.  push() only queues a reference to the caller's cv::Mat
+// (no pixel copy on the producer); the writer copies it into its
+// page-aligned record buffer and writes it.  Pushed images must not be
+// modified afterwards -- the tracker's camera and replay frames are
+// replaced, never written to.  A buffer the caller reuses (the tracking
+// thread's greyscale conversion) goes through pushCopy() instead, which
+// copies into the queue slot's own preallocated image.  A slot stays
+// queued until the writer has copied it out, so neither path allocates
+// or races the writer.  When the queue is full the frame is dropped and counted,
+// never waited for, so recording cannot stall the tracker.  The file is
+// opened with O_DIRECT where the filesystem supports it to keep
+// multi-megabyte frames out of the page cache.
+// ============================================================
+
+class FrameRecorder
+{
+public:
+    FrameRecorder() = default;
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&)            = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    bool open(const std::string& path, int width, int height, int channels,
+              size_t queueDepth = 8);
+    void close();
+
+    bool isOpen() const { return fd_ >= 0; }
+
+    // Non-blocking; keeps a reference to `img` until it is written.
+    // Returns false if the frame was dropped.
+    bool push(const FrameRecordHeader& meta, const cv::Mat& img);
+
+    // As push(), but copies `img` into the queue, so the caller may
+    // overwrite it as soon as this returns.
+    bool pushCopy(const FrameRecordHeader& meta, const cv::Mat& img);
+
+    uint64_t written() const { return written_; }
+    uint64_t dropped() const { return dropped_; }
+
+private:
+    void writerLoop();
+
+    int    fd_         = -1;
+    bool   direct_     = false;
+    int    width_      = 0;
+    int    height_     = 0;
+    int    channels_   = 0;
+    size_t recordSize_ = 0;
+
+    struct Pending
+    {
+        FrameRecordHeader meta;
+        cv::Mat           img;     // what the writer copies out
+        cv::Mat           owned;   // pushCopy()'s pixels, sized at open()
+    };
+
+    bool enqueue(const FrameRecordHeader& meta, const cv::Mat& img, bool copy);
+
+    // Queued frames (ring under mutex_) and the writer's record buffer
+    std::vector<Pending> pending_;
+    size_t               pendingHead_  = 0;
+    size_t               pendingCount_ = 0;
+    uint8_t*             record_       = nullptr;
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    bool                    stop_ = false;
+    std::thread             writer_;
+
+    uint64_t              nextRecord_ = 0;   // writer thread only
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
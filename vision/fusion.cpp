@@ -0,0 +1,73 @@
+#include "fusion.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// ============================================================
+// TRACK FUSION
+// ============================================================
+
+void TrackFusion::reset(size_t cameras, size_t tagSlots, double window)
+{
+    nCams_  = cameras;
+    nTags_  = tagSlots;
+    window_ = window;
+
+    pose_.assign(nCams_ * nTags_, Pose{});
+    conf_.assign(nCams_ * nTags_, 0.0);
+    stamp_.assign(nCams_ * nTags_, -std::numeric_limits<double>::infinity());
+}
+
+void TrackFusion::update(size_t cam, double stamp, const TrackSet& observed, TrackSet& fused)
+{
+    // A camera's latest frame supersedes its earlier sightings: a tag it
+    // no longer sees is no longer vouched for by this camera.
+    const size_t base = cam * nTags_;
+    for (size_t s = 0; s < nTags_; ++s)
+    {
+        if (!observed.visible[s])
+        {
+            stamp_[base + s] = -std::numeric_limits<double>::infinity();
+            continue;
+        }
+        pose_[base + s]  = observed.pose[s];
+        conf_[base + s]  = observed.confidence[s];
+        stamp_[base + s] = stamp;
+    }
+
+    for (size_t s = 0; s < nTags_; ++s)
+    {
+        double newest = -std::numeric_limits<double>::infinity();
+        for (size_t c = 0; c < nCams_; ++c)
+            newest = std::max(newest, stamp_[c * nTags_ + s]);
+
+        // Not seen by any camera recently: keep last pose, drop visibility.
+        if (newest < stamp - window_)
+        {
+            fused.visible[s] = 0;
+            continue;
+        }
+
+        double wSum = 0.0, x = 0.0, y = 0.0, yc = 0.0, ys = 0.0, best = 0.0;
+        for (size_t c = 0; c < nCams_; ++c)
+        {
+            const size_t k = c * nTags_ + s;
+            if (stamp_[k] < newest - window_) continue;
+
+            const double w   = std::max(conf_[k], 1e-6);
+            const double yaw = pose_[k].yaw * M_PI / 180.0;
+            wSum += w;
+            x    += w * pose_[k].x;
+            y    += w * pose_[k].y;
+            yc   += w * std::cos(yaw);
+            ys   += w * std::sin(yaw);
+            best  = std::max(best, conf_[k]);
+        }
+
+        fused.pose[s]       = { x / wSum, y / wSum, std::atan2(ys, yc) * 180.0 / M_PI };
+        fused.confidence[s] = best;
+        fused.visible[s]    = 1;
+        if (observed.visible[s]) fused.corners[s] = observed.corners[s];
+    }
+}
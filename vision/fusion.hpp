@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "tag_registry.hpp"
+
+// ============================================================
+// TRACK FUSION
+//
+// Merges per-camera tag observations into one world track.  For each
+// tag, the observations from cameras that saw it within `window` seconds
+// of the newest sighting are averaged, weighted by confidence.  Older
+// sightings are ignored so a stalled camera cannot drag the track back,
+// and a tag stays visible while any camera's latest frame still shows
+// it.  With a single camera this reduces to "visible this frame".
+// ============================================================
+
+class TrackFusion
+{
+public:
+    void reset(size_t cameras, size_t tagSlots, double window);
+
+    // Record camera `cam`'s visible observations taken at `stamp`
+    // (steady clock seconds) and update `fused` in place.  Slots with no
+    // recent sighting keep their last pose and are marked not visible.
+    void update(size_t cam, double stamp, const TrackSet& observed, TrackSet& fused);
+
+private:
+    size_t nCams_   = 0;
+    size_t nTags_   = 0;
+    double window_  = 0.0;
+
+    // Last sighting per camera and slot, indexed [cam * nTags_ + slot]
+    std::vector<Pose>   pose_;
+    std::vector<double> conf_;
+    std::vector<double> stamp_;
+};
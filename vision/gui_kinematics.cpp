@@ -0,0 +1,116 @@
+#include "gui_kinematics.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+// Values from KinematicsCalculator.__init__ and CppStreamBridge defaults
+constexpr double VEL_ALPHA          = 0.25;
+constexpr double OMEGA_ALPHA        = 0.25;
+constexpr double STATIONARY_EPSILON = 0.002;   // world units (~2 mm)
+constexpr double MAIN_SIZE          = 20.0;
+constexpr double END_MASS_RADIUS    = 12.0;
+
+// ============================================================
+// GUI KINEMATICS
+// ============================================================
+
+static double orbitalAngle(double relX, double relY)
+{
+    double a = std::atan2(relY, relX);
+    if (a < 0.0) a += 2.0 * M_PI;
+    return a;
+}
+
+void GuiKinematics::reset()
+{
+    *this = GuiKinematics();
+}
+
+bool GuiKinematics::update(double timestamp, uint64_t frameId,
+                           double satX, double satY, double endX, double endY,
+                           double confidence, GuiState& out)
+{
+    const double relX  = endX - satX;
+    const double relY  = endY - satY;
+    const double angle = orbitalAngle(relX, relY);
+
+    if (!havePrev_)
+    {
+        havePrev_  = true;
+        prevT_     = timestamp;
+        prevRelX_  = relX;
+        prevRelY_  = relY;
+        prevAngle_ = angle;
+        return false;
+    }
+
+    // Duplicate / out-of-order samples (e.g. two cameras) are dropped,
+    // as process_frame() does.
+    const double dt = timestamp - prevT_;
+    if (dt <= 0.0) return false;
+
+    double rawVx = (relX - prevRelX_) / dt;
+    double rawVy = (relY - prevRelY_) / dt;
+
+    // Shortest angular path in [-pi, pi]
+    double dtheta = std::fmod(angle - prevAngle_ + M_PI, 2.0 * M_PI);
+    if (dtheta < 0.0) dtheta += 2.0 * M_PI;
+    double rawOmega = (dtheta - M_PI) / dt;
+
+    // Stationary deadband: suppress micro-jitter when tags are static
+    if (std::hypot(relX - prevRelX_, relY - prevRelY_) < STATIONARY_EPSILON)
+    {
+        rawVx = rawVy = 0.0;
+        rawOmega = 0.0;
+    }
+
+    velX_  = (1.0 - VEL_ALPHA) * velX_ + VEL_ALPHA * rawVx;
+    velY_  = (1.0 - VEL_ALPHA) * velY_ + VEL_ALPHA * rawVy;
+    omega_ = (1.0 - OMEGA_ALPHA) * omega_ + OMEGA_ALPHA * rawOmega;
+
+    prevT_     = timestamp;
+    prevRelX_  = relX;
+    prevRelY_  = relY;
+    prevAngle_ = angle;
+
+    out.timestamp  = timestamp;
+    out.frameId    = frameId;
+    out.satX       = satX;
+    out.satY       = satY;
+    out.endX       = endX;
+    out.endY       = endY;
+    out.velX       = velX_;
+    out.velY       = velY_;
+    out.angle      = angle;
+    out.omega      = omega_;
+    out.tether     = std::hypot(relX, relY);
+    out.confidence = confidence;
+    return true;
+}
+
+std::string GuiKinematics::payloadJson(const GuiState& s)
+{
+    char buf[640];
+    const int n = std::snprintf(buf, sizeof(buf),
+        "{\"timestamp\":%lld"
+        ",\"satellitePosition\":{\"x\":%.4f,\"y\":%.4f}"
+        ",\"mainPosition\":{\"x\":%.4f,\"y\":%.4f}"
+        ",\"endMassPosition\":{\"x\":%.4f,\"y\":%.4f}"
+        ",\"linearSpeed\":{\"x\":%.5f,\"y\":%.5f}"
+        ",\"angularSpeed\":{\"x\":%.5f,\"y\":%.5f}"
+        ",\"tetherLength\":%.4f"
+        ",\"mainSize\":%.1f"
+        ",\"endMassRadius\":%.1f"
+        ",\"trackingConfidence\":%.3f}",
+        static_cast<long long>(s.timestamp * 1000.0),
+        s.satX, s.satY,
+        s.satX, s.satY,
+        s.endX, s.endY,
+        s.velX, s.velY,
+        s.omega * std::cos(s.angle), s.omega * std::sin(s.angle),
+        s.tether,
+        MAIN_SIZE,
+        END_MASS_RADIUS,
+        s.confidence);
+    return std::string(buf, n > 0 ? static_cast<size_t>(n) : 0);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// ============================================================
+// GUI KINEMATICS
+//
+// C++ port of src/camera/kinematics.py (KinematicsCalculator) and the
+// payload built by cpp_stream_bridge.py, so the tracker can feed the GUI
+// without the Python hop.  Same filters and deadband, same JSON fields;
+// see docs/api.md section 3.
+// ============================================================
+
+struct GuiState
+{
+    double   timestamp   = 0.0;   // unix seconds at capture
+    uint64_t frameId     = 0;
+    double   satX = 0.0, satY = 0.0;
+    double   endX = 0.0, endY = 0.0;
+    double   velX = 0.0, velY = 0.0;   // filtered relative velocity
+    double   angle       = 0.0;        // orbital angle [0, 2pi)
+    double   omega       = 0.0;        // filtered angular velocity
+    double   tether      = 0.0;
+    double   confidence  = 0.0;
+};
+
+class GuiKinematics
+{
+public:
+    // Feed one detector sample.  Returns false until two samples with
+    // increasing timestamps have been seen (the bridge emits nothing then).
+    bool update(double timestamp, uint64_t frameId,
+                double satX, double satY, double endX, double endY,
+                double confidence, GuiState& out);
+
+    void reset();
+
+    static std::string payloadJson(const GuiState& s);
+
+private:
+    bool   havePrev_  = false;
+    double prevT_     = 0.0;
+    double prevRelX_  = 0.0;
+    double prevRelY_  = 0.0;
+    double prevAngle_ = 0.0;
+    double velX_      = 0.0;
+    double velY_      = 0.0;
+    double omega_     = 0.0;
+};
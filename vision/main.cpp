@@ -1,19 +1,24 @@
-#include <iostream>
 #include <thread>
 #include <mutex>
 #include <atomic>
 #include <algorithm>
-#include <map>
 #include <vector>
 #include <chrono>
 #include <cmath>
-#include <sstream>
-#include <iomanip>
 #include <string>
+#include <cstdlib>
+#include <cctype>
+#include <csignal>
+#include <cstdarg>
+#include <cstdio>
+#include <iterator>
+#include <memory>
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <sys/resource.h>
 #include <sys/socket.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
 #include <opencv2/opencv.hpp>
@@ -22,283 +27,380 @@
 #include <gst/app/gstappsink.h>
 
 #include <apriltag/apriltag.h>
-#include <apriltag/tag36h11.h>
+
+#include "alloc_tracker.hpp"
+#include "async_logger.hpp"
+#include "camera.hpp"
+#include "clip_buffer.hpp"
+#include "config.hpp"
+#include "control.hpp"
+#include "frame_file.hpp"
+#include "frame_recorder.hpp"
+#include "fusion.hpp"
+#include "gui_kinematics.hpp"
+#include "metrics.hpp"
+#include "mjpeg_server.hpp"
+#include "orbit_model.hpp"
+#include "perf_counters.hpp"
+#include "pose_core.hpp"
+#include "production_rig.hpp"
+#include "publisher.hpp"
+#include "tag_detector.hpp"
+#include "tag_registry.hpp"
+#include "trace.hpp"
+#include "tracker.hpp"
+#include "trajectory_log.hpp"
+#include "ws_server.hpp"
 
 // ============================================================
 // USER PARAMETERS
 // ============================================================
 
-constexpr int    resolution_divider = 2;
+// Resolution, tag geometry, detector settings, thresholds and the bridge
+// target are runtime settings: see config.hpp (--profile, --config and
+// per-setting flags).
+
+// OpenCV windows: frames are decimated by a whole factor to at most this
+// width; --vis-hz sets the redraw rate
+constexpr int    VIS_MAX_WIDTH      = 1014;
+
+// MJPEG preview (--preview-port, --preview-hz)
+constexpr int    PREVIEW_MAX_WIDTH    = 640;
+constexpr int    PREVIEW_JPEG_QUALITY = 70;
+constexpr int    PREVIEW_NICE         = 19;
+
+// Tracked tags: the satellite plus one or more end masses.  The first
+// end mass is the one reported in the bridge contract's end_mass_position.
+constexpr int    SATELLITE_TAG      = 0;
+constexpr int    END_MASS_TAGS[]    = { 1 };
 
-constexpr int    DISPLAY_W          = 2028;
-constexpr int    DISPLAY_H          = 1520;
+// Per-camera JSON summary in vision.log (pose records default to 1 Hz,
+// --pose-log-hz -1 logs every frame)
+constexpr double SUMMARY_PERIOD_S   = 1.0;
 
-constexpr double TAG_SIZE           = 0.056;   // metres, tracking tags
-constexpr double CALIB_SQUARE       = 0.70;   // metres
+// roi (config / control channel): the detector sees only a window around
+// the previous frame's tracked tags, grown by this many tag diagonals on
+// every side.  The end mass's corners are first moved to where the orbit
+// model expects it.  Any tracked tag missing means a full-frame search.
+constexpr double ROI_MARGIN_TAGS    = 1.0;
 
-constexpr int    TRACK_TAG0         = 0;
-constexpr int    TRACK_TAG1         = 1;
+// --alloc-strict (ALLOC_TRACKING builds): tracked frames after calibration
+// before any allocation on a tracking thread aborts; recalibration
+// disarms it and the count starts over
+constexpr uint64_t ALLOC_WARMUP_FRAMES = 100;
 
-// Confidence thresholds / weights  (tune to your scene)
-constexpr double W_MARGIN           = 0.50;   // decision_margin weight
-constexpr double W_HAMMING          = 0.25;   // hamming penalty weight
-constexpr double W_REPROJ           = 0.15;   // reprojection-error weight
-constexpr double W_SIZE             = 0.10;   // tag pixel-size weight
+// ============================================================
+// ANOMALY CLIPS  (--clip-dir <dir>)
+//
+// The last CLIP_PRE_S seconds of grey frames and tracking states are kept
+// in RAM and saved, together with CLIP_POST_S seconds after the event,
+// when a tracked tag is lost, a jump is rejected, confidence falls below
+// clip_trigger_conf (config), or any datagram arrives on CLIP_TRIGGER_PORT.
+// ============================================================
 
-constexpr double MARGIN_SAT         = 80.0;   // margin value that maps to score 1.0
-constexpr double SIZE_SAT           = 200.0;  // pixel diagonal that maps to score 1.0
-constexpr double REPROJ_MAX         = 5.0;    // reprojection error (px) that maps to score 0.0
-constexpr double MIN_TRACK_CONF      = 0.45;   // reject low-confidence pose outliers
-constexpr double MAX_TRACK_JUMP_M    = 0.20;   // reject implausible frame-to-frame jumps
+constexpr double CLIP_PRE_S         = 4.0;
+constexpr double CLIP_POST_S        = 1.0;
+constexpr double CLIP_EXPECTED_FPS  = 30.0;   // sizes the ring
+constexpr int    CLIP_TRIGGER_PORT  = 9003;
 
 // ============================================================
 // GLOBAL STATE
 // ============================================================
 
 std::atomic<bool>     running(true);
-std::atomic<bool>     calibrated(false);
 std::atomic<uint64_t> frameCounter(0);
 
-std::mutex  frameMutex;
-cv::Mat     latestFrame;
+std::vector<std::unique_ptr<CameraContext>> cameras;
+
+// Runtime settings, fixed once startTracker() has begun
+TrackerConfig config;
+
+bool liveCapture            = true;    // false with --replay
+bool allocStrictAfterWarmup = false;   // --alloc-strict
+bool perfCountersOn         = false;   // --perf-counters
 
 // ============================================================
-// DATA STRUCTS
+// TRACKING STATE
 // ============================================================
 
-struct Pose
-{
-    double x   = 0.0;
-    double y   = 0.0;
-    double yaw = 0.0;   // degrees
-};
+TagRegistry  tags;
+int          satelliteSlot = -1;
+int          endMassSlot   = -1;   // primary end mass
 
-struct TagState
-{
-    Pose   pose;
-    double confidence = 0.0;   // [0 .. 1]
-    bool   visible    = false;
-    std::vector<cv::Point2f> corners;
-};
+// Fused world track; poseMutex also guards fusion, the orbit model and
+// CameraContext::observed
+std::mutex   poseMutex;
+TrackSet     trackState;
+TrackFusion  fusion;
+OrbitModel   orbit;   // primary end mass about the satellite (orbit_model config)
 
-static bool isPlausibleJump(const TagState& previous, const TagState& current)
+static bool isPlausibleJump(const TrackSet& previous, const OrbitModel& model, double stamp,
+                            int slot, const Pose& current)
 {
+    // The end mass while the orbit model has lock: its gate, which grows
+    // with the spin rate
+    if (slot == endMassSlot && model.locked(stamp))
+        return model.accepts(stamp, tags.maxJump[slot], current);
+
     // If previous pose was not visible, accept reacquisition directly.
-    if (!previous.visible) return true;
-    const double dx = current.pose.x - previous.pose.x;
-    const double dy = current.pose.y - previous.pose.y;
+    if (!previous.visible[slot]) return true;
+    const double dx = current.x - previous.pose[slot].x;
+    const double dy = current.y - previous.pose[slot].y;
     const double jump = std::sqrt(dx * dx + dy * dy);
-    return jump <= MAX_TRACK_JUMP_M;
+    return jump <= tags.maxJump[slot];
 }
 
-std::mutex   poseMutex;
-TagState     tag0State;
-TagState     tag1State;
+// Detector contract to the Python bridge (config.bridge) plus any
+// --publish subscribers
+Publisher publisher;
 
-// UDP output for Python bridge (Detector Contract)
-int udpSock = -1;
-sockaddr_in udpAddr{};
+// Grey frames seen by the tracker (--record <file>)
+FrameRecorder recorder;
 
-// Camera -> world transform
-cv::Mat R_wc;
-cv::Mat t_wc;
+// Pre-trigger ring saved on anomalies (--clip-dir <dir>)
+ClipBuffer    clips;
 
-// ============================================================
-// CAMERA INTRINSICS  (full-res values, divided by resolution_divider)
-// ============================================================
+// Binary per-tag pose log (--traj-log <file>)
+TrajectoryWriter trajLog;
+
+// Optional built-in GUI stream (--ws-port), replaces cpp_stream_bridge.py;
+// fed from the publisher thread
+WsServer      guiServer;
+GuiKinematics guiKinematics;
 
-cv::Mat K = (cv::Mat1d(3, 3) <<
-    4009.22661 / resolution_divider, 0.0,  2113.49677 / resolution_divider,
-    0.0, 4020.48344 / resolution_divider,  1469.08894 / resolution_divider,
-    0.0, 0.0, 1.0);
+// Optional annotated MJPEG preview (--preview-port)
+MjpegServer   previewServer;
 
-cv::Mat D = (cv::Mat1d(1, 5) <<
-    -0.49, 0.28, 0.0, 0.0, -0.09);
+// Runtime settings changed over --control; read by the tracking threads
+// between frames
+ControlState  control;
+ControlServer controlServer;
 
 // ============================================================
 // WORLD CORNERS OF CALIBRATION TAGS
 // ============================================================
 
-std::map<int, std::vector<cv::Point3f>> worldTagCorners =
+// Corner order matches the detector's p[0..3]; (ox, oy) is corner 0.
+static TagCorners3f calibTagCorners(double ox, double oy)
 {
-    {2, { {-CALIB_SQUARE/2,           -CALIB_SQUARE/2,           0},
-          {-CALIB_SQUARE/2+TAG_SIZE,  -CALIB_SQUARE/2,           0},
-          {-CALIB_SQUARE/2+TAG_SIZE,  -CALIB_SQUARE/2+TAG_SIZE,  0},
-          {-CALIB_SQUARE/2,           -CALIB_SQUARE/2+TAG_SIZE,  0} }},
-
-    {3, { { CALIB_SQUARE/2,           -CALIB_SQUARE/2,           0},
-          { CALIB_SQUARE/2+TAG_SIZE,  -CALIB_SQUARE/2,           0},
-          { CALIB_SQUARE/2+TAG_SIZE,  -CALIB_SQUARE/2+TAG_SIZE,  0},
-          { CALIB_SQUARE/2,           -CALIB_SQUARE/2+TAG_SIZE,  0} }},
+    const double s = config.tagSize;
+    return {{ { (float)ox,       (float)oy,       0 },
+              { (float)(ox + s), (float)oy,       0 },
+              { (float)(ox + s), (float)(oy + s), 0 },
+              { (float)ox,       (float)(oy + s), 0 } }};
+}
 
-    {4, { { CALIB_SQUARE/2,           CALIB_SQUARE/2,            0},
-          { CALIB_SQUARE/2+TAG_SIZE,   CALIB_SQUARE/2,            0},
-          { CALIB_SQUARE/2+TAG_SIZE,   CALIB_SQUARE/2+TAG_SIZE,   0},
-          { CALIB_SQUARE/2,            CALIB_SQUARE/2+TAG_SIZE,   0} }},
+static void registerTags()
+{
+    const double h = config.calibSquare / 2;
+    tags.addCalibration(2, calibTagCorners(-h, -h));
+    tags.addCalibration(3, calibTagCorners( h, -h));
+    tags.addCalibration(4, calibTagCorners( h,  h));
+    tags.addCalibration(5, calibTagCorners(-h,  h));
+
+    satelliteSlot = tags.addTracking(
+        SATELLITE_TAG, "tag" + std::to_string(SATELLITE_TAG), config.maxTrackJumpM);
+    for (int id : END_MASS_TAGS)
+    {
+        int slot = tags.addTracking(id, "tag" + std::to_string(id), config.maxTrackJumpM);
+        if (endMassSlot < 0) endMassSlot = slot;
+    }
 
-    {5, { {-CALIB_SQUARE/2,            CALIB_SQUARE/2,            0},
-          {-CALIB_SQUARE/2+TAG_SIZE,   CALIB_SQUARE/2,            0},
-          {-CALIB_SQUARE/2+TAG_SIZE,   CALIB_SQUARE/2+TAG_SIZE,   0},
-          {-CALIB_SQUARE/2,            CALIB_SQUARE/2+TAG_SIZE,   0} }}
-};
+    trackState.resize(tags.trackCount());
+    for (auto& cam : cameras)
+        cam->observed.resize(tags.trackCount());
+    fusion.reset(cameras.size(), tags.trackCount(), config.fusionWindowS);
+    orbit.reset();
+}
 
 // ============================================================
-// HELPERS
+// CAMERA CAPTURE
+//
+// By default each camera's appsink hands samples over from its new-sample
+// callback, on the pipeline's own streaming thread, so a frame reaches
+// the tracking thread without a hop through a capture thread.
+// --capture-thread restores the old blocking pull loop, for comparing
+// the two (vision_stage_seconds{stage="capture"}).
 // ============================================================
 
-// Clamp x to [0, 1]
-static inline double clamp01(double x)
+static double steadySeconds()
 {
-    return std::max(0.0, std::min(1.0, x));
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-// Pixel-space diagonal of the detected quad
-static double tagPixelDiagonal(apriltag_detection_t* det)
+static double unixSeconds()
 {
-    double dx = det->p[2][0] - det->p[0][0];
-    double dy = det->p[2][1] - det->p[0][1];
-    return std::sqrt(dx*dx + dy*dy);
+    return std::chrono::duration<double>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
 }
 
-// Reprojection error: re-project 3-D tag corners back with the solved pose,
-// compare to detected 2-D corners.  Returns mean error in pixels.
-static double reprojectionError(
-    const std::vector<cv::Point3f>& obj,
-    const std::vector<cv::Point2f>& img,
-    const cv::Mat& rvec,
-    const cv::Mat& tvec)
+// Hand a new frame to the camera's tracking thread.
+static void publishFrame(CameraContext& cam, cv::Mat frame, uint64_t seq,
+                         double stamp, double unixTime)
 {
-    std::vector<cv::Point2f> projected;
-    cv::projectPoints(obj, rvec, tvec, K, D, projected);
-
-    double err = 0.0;
-    for (size_t i = 0; i < img.size(); ++i)
     {
-        double dx = img[i].x - projected[i].x;
-        double dy = img[i].y - projected[i].y;
-        err += std::sqrt(dx*dx + dy*dy);
+        ProfiledLock lock(cam.frameMutex, LockSite::FramePublish);
+        cam.latestFrame = std::move(frame);
+        cam.latestSeq   = seq;
+        cam.latestStamp = stamp;
+        cam.latestUnix  = unixTime;
+        cam.latestHandoff = steadySeconds();
     }
-    return err / static_cast<double>(img.size());
+    cam.frameReady.notify_all();
+    metrics.camera(cam.index).captured.fetch_add(1, std::memory_order_relaxed);
 }
 
-// ============================================================
-// CONFIDENCE SCORE
-//
-// Combines four signals:
-//
-//   1. decision_margin  – how unambiguous the bit pattern match was.
-//                         Higher = better.  Saturates at MARGIN_SAT.
-//
-//   2. hamming distance – number of bit-errors corrected.
-//                         0 → score 1.0,  1 → 0.5,  2 → 0.0.
-//                         (tag36h11 allows up to hamming=1 by default)
-//
-//   3. reprojection err – mean pixel error after solvePnP.
-//                         0 px → 1.0,  REPROJ_MAX px → 0.0.
-//
-//   4. tag pixel size   – larger apparent size = more detail = better.
-//                         Saturates at SIZE_SAT px diagonal.
-//
-// Final score is a weighted sum, clamped to [0, 1].
-// ============================================================
+// Steady-clock time the buffer was captured: its timestamp against the
+// pipeline clock, or now when it carries none.  Both hand-over paths
+// report the same instant, so their latencies compare directly.
+static double captureTime(const CameraContext& cam, GstBuffer* buffer)
+{
+    const double now = steadySeconds();
+    const GstClockTime pts = GST_BUFFER_PTS(buffer);
+    GstClock* clock = gst_element_get_clock(cam.pipe);
+    if (!clock) return now;
+
+    const GstClockTime running = gst_clock_get_time(clock) - gst_element_get_base_time(cam.pipe);
+    gst_object_unref(clock);
+    if (!GST_CLOCK_TIME_IS_VALID(pts) || running < pts) return now;
+    return now - static_cast<double>(running - pts) * 1e-9;
+}
 
-static double computeConfidence(
-    apriltag_detection_t* det,
-    const cv::Mat& rvec,
-    const cv::Mat& tvec,
-    const std::vector<cv::Point3f>& obj,
-    const std::vector<cv::Point2f>& img)
+// Copy one sample out of GStreamer's buffer and publish it; takes
+// ownership of the sample.
+static void deliverSample(CameraContext& cam, GstSample* sample)
 {
-    // --- 1. decision_margin score ---
-    double s_margin = clamp01(det->decision_margin / MARGIN_SAT);
+    const uint64_t seq = ++cam.captureSeq;
+    StageTimer copyTimer(Stage::Copy);
 
-    // --- 2. hamming score ---
-    double s_hamming;
-    switch (det->hamming)
+    auto buffer = gst_sample_get_buffer(sample);
+    const double stamp = captureTime(cam, buffer);
+    GstMapInfo map;
     {
-        case 0:  s_hamming = 1.00; break;
-        case 1:  s_hamming = 0.50; break;
-        default: s_hamming = 0.00; break;   // ≥2 errors → discard
+        TraceScope t("map", seq);
+        gst_buffer_map(buffer, &map, GST_MAP_READ);
     }
 
-    // --- 3. reprojection error score ---
-    double reproj   = reprojectionError(obj, img, rvec, tvec);
-    double s_reproj = clamp01(1.0 - reproj / REPROJ_MAX);
+    auto caps = gst_sample_get_caps(sample);
+    auto s    = gst_caps_get_structure(caps, 0);
 
-    // --- 4. pixel size score ---
-    double diag   = tagPixelDiagonal(det);
-    double s_size = clamp01(diag / SIZE_SAT);
+    int w, h;
+    gst_structure_get_int(s, "width",  &w);
+    gst_structure_get_int(s, "height", &h);
 
-    // --- weighted sum ---
-    double confidence =
-        W_MARGIN  * s_margin  +
-        W_HAMMING * s_hamming +
-        W_REPROJ  * s_reproj  +
-        W_SIZE    * s_size;
+    cv::Mat frame(h, w, CV_8UC3, map.data);
+    {
+        TraceScope t("clone", seq);
+        publishFrame(cam, frame.clone(), seq, stamp, unixSeconds());
+    }
 
-    return clamp01(confidence);
+    gst_buffer_unmap(buffer, &map);
+    gst_sample_unref(sample);
 }
 
-// ============================================================
-// APRILTAG DETECTOR
-// ============================================================
-
-static apriltag_detector_t* createDetector()
+// appsink new-sample, on the camera pipeline's streaming thread
+static GstFlowReturn onNewSample(GstAppSink* sink, gpointer user)
 {
-    auto tf = tag36h11_create();
-    auto td = apriltag_detector_create();
-    apriltag_detector_add_family(td, tf);
-    td->quad_decimate  = 2.0;
-    td->nthreads       = 4;
-    td->refine_edges   = 1;
-    return td;
+    CameraContext& cam = *static_cast<CameraContext*>(user);
+    thread_local bool named = false;
+    if (!named)
+    {
+        traceThread("capture " + cam.id);
+        named = true;
+    }
+
+    GstSample* sample = gst_app_sink_pull_sample(sink);   // one is waiting
+    if (sample) deliverSample(cam, sample);
+    return GST_FLOW_OK;
 }
 
-// ============================================================
-// CAMERA CAPTURE THREAD
-// ============================================================
+static void connectSampleCallback(CameraContext& cam)
+{
+    GstAppSinkCallbacks callbacks{};
+    callbacks.new_sample = onNewSample;
+    gst_app_sink_set_callbacks(GST_APP_SINK(cam.sink), &callbacks, &cam, nullptr);
+}
 
-void captureThread(GstElement* sink)
+// --capture-thread
+void captureThread(CameraContext& cam)
 {
+    traceThread("capture " + cam.id);
+
     while (running)
     {
-        auto sample = gst_app_sink_pull_sample(GST_APP_SINK(sink));
-        if (!sample) continue;
-
-        auto buffer = gst_sample_get_buffer(sample);
-        GstMapInfo map;
-        gst_buffer_map(buffer, &map, GST_MAP_READ);
-
-        auto caps = gst_sample_get_caps(sample);
-        auto s    = gst_caps_get_structure(caps, 0);
+        GstSample* sample;
+        {
+            TraceScope t("pull_sample", cam.captureSeq + 1);
+            sample = gst_app_sink_pull_sample(GST_APP_SINK(cam.sink));
+        }
+        if (sample) deliverSample(cam, sample);
+    }
+}
 
-        int w, h;
-        gst_structure_get_int(s, "width",  &w);
-        gst_structure_get_int(s, "height", &h);
+// ============================================================
+// REPLAY THREAD
+//
+// Feeds a recorded frame file to the tracking threads in place of the
+// cameras.  Frames are handed over one at a time and each is processed
+// before the next is published, so a replay sees exactly the recorded
+// frames with their original capture timestamps.
+// ============================================================
 
-        cv::Mat frame(h, w, CV_8UC3, map.data);
+void replayThread(const FrameFileReader* reader)
+{
+    traceThread("replay");
+    for (size_t i = 0; i < reader->size() && running; ++i)
+    {
+        const FrameRecordHeader& meta = reader->meta(i);
+        if (meta.camera >= cameras.size()) continue;
 
-        {
-            std::lock_guard<std::mutex> lock(frameMutex);
-            latestFrame = frame.clone();
-        }
+        CameraContext& cam = *cameras[meta.camera];
+        publishFrame(cam, reader->image(i), meta.seq, meta.stamp, meta.unixTime);
 
-        gst_buffer_unmap(buffer, &map);
-        gst_sample_unref(sample);
+        while (running && cam.processedSeq.load() != meta.seq)
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
     }
+
+    logInfo("Replay finished (%zu frames)", reader->size());
+    running = false;
+    for (auto& cam : cameras) cam->frameReady.notify_all();
 }
 
 // ============================================================
-// CAMERA -> WORLD
+// CLIP TRIGGER THREAD
+//
+// Any datagram on CLIP_TRIGGER_PORT saves a clip, e.g.
+//   echo clip | nc -u -w0 <pi-host> 9003
 // ============================================================
 
-static cv::Point3f camToWorld(const cv::Mat& tvec)
+void clipTriggerThread()
 {
-    if (R_wc.empty() || t_wc.empty()) return {0, 0, 0};
-    cv::Mat p = R_wc * tvec + t_wc;
-    return { (float)p.at<double>(0),
-             (float)p.at<double>(1),
-             (float)p.at<double>(2) };
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) return;
+
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(CLIP_TRIGGER_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    timeval tv{0, 200000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    if (bind(sock, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        logWarn("Clip trigger port %d unavailable", CLIP_TRIGGER_PORT);
+        close(sock);
+        return;
+    }
+
+    char buf[256];
+    while (running)
+    {
+        if (recv(sock, buf, sizeof(buf), 0) >= 0)
+            clips.trigger(ClipTrigger::External);
+    }
+    close(sock);
 }
 
 // ============================================================
@@ -306,16 +408,17 @@ static cv::Point3f camToWorld(const cv::Mat& tvec)
 // ============================================================
 
 static bool calibrate(
+    CameraContext& cam,
     std::vector<cv::Point2f>& imgPts,
     std::vector<cv::Point3f>& objPts)
 {
     if (imgPts.size() < 8) return false;
 
     cv::Mat rvec;
-    cv::solvePnP(objPts, imgPts, K, D, rvec, t_wc);
-    cv::Rodrigues(rvec, R_wc);
-    calibrated = true;
-    std::cerr << "[INFO] Calibration successful\n";
+    cv::solvePnP(objPts, imgPts, cam.K, cam.D, rvec, cam.t_wc);
+    cv::Rodrigues(rvec, cam.R_wc);
+    cam.calibrated = true;
+    logInfo("Calibration successful (%s)", cam.id.c_str());
     return true;
 }
 
@@ -323,368 +426,1345 @@ static bool calibrate(
 // JSON HELPERS
 // ============================================================
 
-// Fixed-precision double -> string (avoids locale issues with printf)
-static std::string fp(double v, int prec = 4)
+static void appendTagJson(AsyncLogger::Record& rec, const std::string& key,
+                          const TrackSet& ts, int slot)
+{
+    rec.appendf(",\"%s\":{\"x\":%.4f,\"y\":%.4f,\"yaw\":%.4f,\"conf\":%.3f,\"visible\":%s}",
+                key.c_str(), ts.pose[slot].x, ts.pose[slot].y, ts.pose[slot].yaw,
+                ts.confidence[slot], ts.visible[slot] ? "true" : "false");
+}
+
+// Frame rate and per-tag visibility / confidence over one summary period
+struct SummaryStats
+{
+    double                start     = 0.0;
+    uint64_t              frames    = 0;
+    uint64_t              solves    = 0;   // pose solves / reuses (SightingCache)
+    uint64_t              cacheHits = 0;
+    std::vector<uint32_t> seen;
+    std::vector<double>   confSum;
+    AllocCounts           allocs;    // tracking thread's totals at start
+    PerfSample            perf[static_cast<int>(Stage::Count)];   // --perf-counters
+
+    void reset(double now, size_t nTags)
+    {
+        start     = now;
+        frames    = 0;
+        solves    = 0;
+        cacheHits = 0;
+        seen.assign(nTags, 0);
+        confSum.assign(nTags, 0.0);
+        allocs = threadAllocs();
+        for (auto& p : perf) p = PerfSample{};
+    }
+};
+
+// `model`: the orbit model when it has lock, else null
+static void logSummary(const CameraContext& cam, const SummaryStats& st, double now,
+                       const OrbitModel* model)
 {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(prec) << v;
-    return oss.str();
+    auto rec = logger.begin(LogChannel::Summary);
+    if (!rec) return;
+
+    const double span = std::max(now - st.start, 1e-6);
+    rec.appendf("{\"summary\":{\"camera\":\"%s\",\"frames\":%llu,\"fps\":%.2f",
+                cam.id.c_str(), static_cast<unsigned long long>(st.frames), st.frames / span);
+    if (st.solves + st.cacheHits)
+        rec.appendf(",\"pose_cache_hit_rate\":%.3f", double(st.cacheHits) / (st.solves + st.cacheHits));
+    if (ALLOC_TRACKING && st.frames)
+    {
+        const AllocCounts a = threadAllocs();
+        rec.appendf(",\"allocs_per_frame\":%.1f,\"alloc_bytes_per_frame\":%.0f",
+                    double(a.count - st.allocs.count) / st.frames,
+                    double(a.bytes - st.allocs.bytes) / st.frames);
+    }
+    if (st.perf[static_cast<int>(Stage::Frame)].v[PerfInstructions] && st.frames)
+    {
+        // Per stage: Mcycles per frame, IPC, cache / branch misses per 1000 instructions
+        rec.appendf(",\"perf\":{");
+        const char* sep = "";
+        for (Stage s : { Stage::Detect, Stage::Pose, Stage::Fuse, Stage::Frame })
+        {
+            const PerfSample& p = st.perf[static_cast<int>(s)];
+            if (!p.v[PerfCycles] || !p.v[PerfInstructions]) continue;
+            const double kinstr = p.v[PerfInstructions] / 1000.0;
+            rec.appendf("%s\"%s\":{\"mcycles\":%.2f,\"ipc\":%.2f,\"cache_mpki\":%.2f,\"branch_mpki\":%.2f}",
+                        sep, stageName(s),
+                        p.v[PerfCycles] / 1e6 / st.frames,
+                        double(p.v[PerfInstructions]) / p.v[PerfCycles],
+                        p.v[PerfCacheMisses] / kinstr,
+                        p.v[PerfBranchMisses] / kinstr);
+            sep = ",";
+        }
+        rec.appendf("}");
+    }
+    if (model)
+        rec.appendf(",\"orbit\":{\"omega\":%.3f,\"radius\":%.4f}", model->omega(), model->radius());
+    rec.appendf(",\"tags\":{");
+    for (size_t k = 0; k < st.seen.size(); ++k)
+    {
+        const double vis  = st.frames ? double(st.seen[k]) / st.frames : 0.0;
+        const double conf = st.seen[k] ? st.confSum[k] / st.seen[k] : 0.0;
+        rec.appendf("%s\"%s\":{\"visible\":%.3f,\"conf\":%.3f}",
+                    k ? "," : "", tags.trackNames[k].c_str(), vis, conf);
+    }
+    rec.appendf("}}}");
+    logger.commit(rec);
 }
 
-static std::string tagJson(const std::string& key, const TagState& ts)
+// GUI payload straight from the tracker (same fields as the bridge).
+// Runs on the publisher thread.
+static void publishGui(const PoseSnapshot& snap)
 {
-    return "\"" + key + "\":{"
-        "\"x\":"          + fp(ts.pose.x)    +
-        ",\"y\":"         + fp(ts.pose.y)     +
-        ",\"yaw\":"       + fp(ts.pose.yaw)   +
-        ",\"conf\":"      + fp(ts.confidence, 3) +
-        ",\"visible\":"   + (ts.visible ? "true" : "false") +
-        "}";
+    const TrackSet& ts = snap.tracks;
+    if (!ts.visible[satelliteSlot] || !ts.visible[endMassSlot]) return;
+
+    const Pose& satellite = ts.pose[satelliteSlot];
+    const Pose& endMass   = ts.pose[endMassSlot];
+    const double conf = std::min(ts.confidence[satelliteSlot],
+                                 ts.confidence[endMassSlot]);
+
+    GuiState state;
+    if (guiKinematics.update(snap.unixTime, snap.frameId, satellite.x, satellite.y,
+                             endMass.x, endMass.y, conf, state))
+        guiServer.publish(GuiKinematics::payloadJson(state));
 }
 
-static bool initUdpSender(const std::string& host = "127.0.0.1", int port = 9001)
+// Registered last, so the publish latency covers every subscriber and sink.
+static void recordPublished(const PoseSnapshot& snap)
 {
-    udpSock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (udpSock < 0) return false;
+    metrics.published();
+    metrics.stage(Stage::Publish, static_cast<int64_t>((steadySeconds() - snap.postedAt) * 1e9));
+}
+
+// ============================================================
+// POSE STAGE
+//
+// One frame's detections through a pose core (pose_core.hpp): tracking
+// tags become gated sightings in `next`, calibration-tag corners are
+// collected for calibrate().  Instantiated for the fixed production rig
+// and for the runtime-configured one.
+// ============================================================
 
-    udpAddr = {};
-    udpAddr.sin_family = AF_INET;
-    udpAddr.sin_port   = htons(port);
-    if (inet_pton(AF_INET, host.c_str(), &udpAddr.sin_addr) != 1)
+// True when this camera and the runtime config are exactly the rig the
+// fixed variant was compiled for
+static bool isProductionRig(const CameraContext& cam)
+{
+    const CameraSpec& spec = CAMERA_SPECS[cam.index];
+    return config.resolutionDivider == ProductionRig::DIVIDER &&
+           config.tagSize == ProductionRig::TAG_SIZE &&
+           spec.fx == ProductionRig::FX_FULL && spec.fy == ProductionRig::FY_FULL &&
+           spec.cx == ProductionRig::CX_FULL && spec.cy == ProductionRig::CY_FULL &&
+           spec.dist[0] == ProductionRig::K1 && spec.dist[1] == ProductionRig::K2 &&
+           spec.dist[2] == ProductionRig::P1 && spec.dist[3] == ProductionRig::P2 &&
+           spec.dist[4] == ProductionRig::K3 &&
+           std::equal(tags.trackIds.begin(), tags.trackIds.end(),
+                      ProductionRig::TAG_IDS.begin(), ProductionRig::TAG_IDS.end());
+}
+
+template <class Core>
+static void trackDetections(
+    const Core& core,
+    SightingCache& cache,
+    const CameraContext& cam,
+    zarray_t* detections,
+    const TrackSet& prev,
+    const OrbitModel& model,
+    double stamp,
+    TrackSet& next,
+    std::vector<cv::Point2f>& calibImg,
+    std::vector<cv::Point3f>& calibObj,
+    uint64_t seq,
+    uint64_t frameId)
+{
+    TagSighting sighting;
+    for (int i = 0; i < zarray_size(detections); ++i)
     {
-        close(udpSock);
-        udpSock = -1;
-        return false;
+        apriltag_detection_t* det;
+        zarray_get(detections, i, &det);
+
+        // Skip very low-quality detections early
+        if (det->hamming > 1) continue;
+
+        // --- Calibration tag corners ---
+        const int calib = tags.calibSlot(det->id);
+        if (calib >= 0)
+        {
+            const TagCorners3f& world = tags.calibCorners[calib];
+            for (int k = 0; k < 4; ++k)
+            {
+                calibImg.emplace_back(det->p[k][0], det->p[k][1]);
+                calibObj.push_back(world[k]);
+            }
+            continue;
+        }
+
+        // --- Tracking tags ---
+        const int slot = core.trackSlot(det->id);
+        if (cam.calibrated && slot >= 0)
+        {
+            if (!cache.reuse(slot, det, config.poseCachePx, sighting))
+            {
+                TraceScope t("pnp", seq, frameId);
+                AllocStrictPause pause;   // solvePnP allocates inside OpenCV
+                core.solve(det, sighting);
+                cache.store(slot, det, sighting);
+            }
+
+            // Hard reject low-confidence detections: they are a major source
+            // of repeated "fixed-value" spikes when a false tag pose appears.
+            if (sighting.confidence < config.minTrackConf) continue;
+
+            if (!isPlausibleJump(prev, model, stamp, slot, sighting.pose))
+            {
+                clips.trigger(ClipTrigger::JumpRejected);
+                continue;
+            }
+
+            next.pose[slot]       = sighting.pose;
+            next.confidence[slot] = sighting.confidence;
+            next.visible[slot]    = 1;
+            next.corners[slot]    = sighting.corners;
+        }
     }
-    return true;
 }
 
-static void sendDetectorContract(
-    uint64_t frameId,
-    double unixSeconds,
-    const TagState& satellite,
-    const TagState& endMass)
+// ============================================================
+// REGION OF INTEREST
+// ============================================================
+
+// Window around every tracked tag of the last frame, or the whole image
+// when one of them was not seen
+static cv::Rect trackingRoi(const TrackSet& last, cv::Size size)
 {
-    if (udpSock < 0) return;
+    const cv::Rect full(0, 0, size.width, size.height);
+    if (last.size() == 0) return full;
 
-    // orbital angle from satellite -> end-mass vector (radians)
-    const double dx = endMass.pose.x - satellite.pose.x;
-    const double dy = endMass.pose.y - satellite.pose.y;
-    const double orbital = std::atan2(dy, dx);
-    const double conf = std::min(satellite.confidence, endMass.confidence);
+    float x0 = INFINITY, y0 = INFINITY, x1 = -INFINITY, y1 = -INFINITY, diag = 0.0f;
+    for (size_t k = 0; k < last.size(); ++k)
+    {
+        if (!last.visible[k]) return full;
+        const TagCorners2f& c = last.corners[k];
+        for (const auto& p : c)
+        {
+            x0 = std::min(x0, p.x);  y0 = std::min(y0, p.y);
+            x1 = std::max(x1, p.x);  y1 = std::max(y1, p.y);
+        }
+        diag = std::max(diag, std::hypot(c[2].x - c[0].x, c[2].y - c[0].y));
+    }
 
-    std::string payload =
-        "{"
-        "\"timestamp\":" + fp(unixSeconds, 6) +
-        ",\"frame_id\":" + std::to_string(frameId) +
-        ",\"camera_id\":\"cam0\"" +
-        ",\"satellite_position\":{\"x\":" + fp(satellite.pose.x) + ",\"y\":" + fp(satellite.pose.y) + "}" +
-        ",\"end_mass_position\":{\"x\":" + fp(endMass.pose.x) + ",\"y\":" + fp(endMass.pose.y) + "}" +
-        ",\"orbital_angular_position\":" + fp(orbital, 6) +
-        ",\"tracking_confidence\":" + fp(conf, 3) +
-        "}";
+    const float m = static_cast<float>(ROI_MARGIN_TAGS) * diag;
+    const cv::Rect roi(cv::Point(static_cast<int>(x0 - m), static_cast<int>(y0 - m)),
+                       cv::Point(static_cast<int>(x1 + m) + 1, static_cast<int>(y1 + m) + 1));
+    return roi & full;
+}
+
+// Last frame's sightings with the end mass's corners shifted by the
+// image motion the orbit model predicts for it by `stamp`.  Both
+// positions are projected on the calibration plane (z = 0); the tag's
+// height mostly cancels in the difference.
+template <class Core>
+static void predictSightings(const Core& core, const OrbitModel& model, double stamp,
+                             const TrackSet& last, TrackSet& expected)
+{
+    expected = last;
+    OrbitPrediction p;
+    if (endMassSlot < 0 || !last.visible[endMassSlot] || !model.predict(stamp, 0.0, p))
+        return;
+
+    const Pose& from = last.pose[endMassSlot];
+    const cv::Point2d a = core.projectWorld(cv::Vec3d(from.x, from.y, 0.0));
+    const cv::Point2d b = core.projectWorld(cv::Vec3d(p.x, p.y, 0.0));
+    for (auto& c : expected.corners[endMassSlot])
+    {
+        c.x += static_cast<float>(b.x - a.x);
+        c.y += static_cast<float>(b.y - a.y);
+    }
+}
 
-    (void)sendto(
-        udpSock,
-        payload.c_str(),
-        payload.size(),
-        0,
-        reinterpret_cast<const sockaddr*>(&udpAddr),
-        sizeof(udpAddr));
+// Window detections back to full-image pixels
+static void offsetDetections(zarray_t* detections, cv::Point offset)
+{
+    for (int i = 0; i < zarray_size(detections); ++i)
+    {
+        apriltag_detection_t* det;
+        zarray_get(detections, i, &det);
+        for (int k = 0; k < 4; ++k)
+        {
+            det->p[k][0] += offset.x;
+            det->p[k][1] += offset.y;
+        }
+        det->c[0] += offset.x;
+        det->c[1] += offset.y;
+    }
 }
 
 // ============================================================
 // TRACKING THREAD
 // ============================================================
 
-void trackingThread()
+void trackingThread(CameraContext& cam)
 {
-    auto detector = createDetector();
-
-    // 3-D corners for a tracking tag (in tag-local frame, z=0)
-    const std::vector<cv::Point3f> trackObj =
-    {
-        {-TAG_SIZE/2, -TAG_SIZE/2, 0},
-        { TAG_SIZE/2, -TAG_SIZE/2, 0},
-        { TAG_SIZE/2,  TAG_SIZE/2, 0},
-        {-TAG_SIZE/2,  TAG_SIZE/2, 0}
-    };
+    traceThread("tracking " + cam.id);
+    auto detector = createDetector(config.detector);
+
+    // Pose math: the compiled-in production rig when this camera and the
+    // config match it, otherwise the runtime-configured variant
+    PoseCore<DynamicRig>              dynamicCore(DynamicRig(cam.K, cam.D, config.tagSize, &tags));
+    PoseCore<FixedRig<ProductionRig>> fixedCore;
+    const bool fixedRig = FIXED_RIG && isProductionRig(cam);
+    SightingCache poseCache;
+    poseCache.resize(tags.trackCount());
+    logInfo("%s: %s pose variant", cam.id.c_str(), fixedRig ? "fixed (production rig)" : "runtime");
+
+    // Per-frame buffers, sized once and reused across iterations
+    TrackSet prev, next, out, expected;
+    next.resize(tags.trackCount());
+    OrbitModel orbitSeen;   // copy of the shared model, taken with prev / after fusing
+    std::vector<cv::Point2f> calibImg;
+    std::vector<cv::Point3f> calibObj;
+    cv::Mat grayBuf;   // greyscale conversion of live (BGR) frames
+
+    uint64_t lastSeq = 0;
+    CameraMetrics& stats = metrics.camera(cam.index);
+    uint64_t warmFrames  = 0;
+
+    PerfCounters perf;
+    if (perfCountersOn && perf.open())
+        logInfo("%s: hardware counters on", cam.id.c_str());
+
+    SummaryStats summary;
+    summary.reset(steadySeconds(), tags.trackCount());
+
+    // Control channel settings, refreshed when their generation moves
+    uint64_t controlGen = UINT64_MAX;
+    bool     roiMode    = false;
+    bool     recording  = false;
 
     while (running)
     {
-        cv::Mat frame;
+        const uint64_t gen = control.generation.load(std::memory_order_acquire);
+        if (gen != controlGen)
         {
-            std::lock_guard<std::mutex> lock(frameMutex);
-            if (latestFrame.empty()) continue;
-            frame = latestFrame.clone();
+            controlGen = gen;
+            roiMode    = control.roi.load(std::memory_order_relaxed);
+            recording  = control.recording.load(std::memory_order_relaxed);
+            detector->quad_decimate =
+                static_cast<float>(control.quadDecimate.load(std::memory_order_relaxed));
+            if (cam.recalibrate.exchange(false))
+            {
+                cam.calibrated = false;
+                allocStrict(false);   // calibration points and solvePnP allocate
+                warmFrames = 0;
+                logInfo("Recalibrating (%s)", cam.id.c_str());
+            }
+            cam.controlSeen.store(gen, std::memory_order_release);
         }
 
-        ++frameCounter;
-
-        // --- Greyscale conversion ---
+        cv::Mat  frame;
+        uint64_t seq;
+        double   stamp, unixTime, handoff;
+        {
+            ProfiledLock lock(cam.frameMutex, LockSite::FramePickup);
+            lock.waitFor(cam.frameReady, std::chrono::milliseconds(100), [&]
+            {
+                return cam.latestSeq != lastSeq || !running;
+            });
+            if (cam.latestSeq == lastSeq || cam.latestFrame.empty()) continue;
+
+            frame    = cam.latestFrame;   // publishers replace, never modify
+            seq      = cam.latestSeq;
+            stamp    = cam.latestStamp;
+            unixTime = cam.latestUnix;
+            handoff  = cam.latestHandoff;
+        }
+        if (lastSeq != 0 && seq > lastSeq + 1)
+            stats.skipped.fetch_add(seq - lastSeq - 1, std::memory_order_relaxed);
+        lastSeq = seq;
+
+        const uint64_t frameId = ++frameCounter;
+        TraceScope traceFrame("frame", seq, frameId);
+        StageTimer frameTimer(Stage::Frame);
+        PerfScope  framePerf(perf, summary.perf[static_cast<int>(Stage::Frame)]);
+        const AllocCounts allocsBefore = threadAllocs();
+        metrics.stage(Stage::Queue, static_cast<int64_t>((steadySeconds() - handoff) * 1e9));
+
+        // --- Greyscale conversion (replayed frames are already grey) ---
+        // Converted frames land in grayBuf, reused across frames so the
+        // conversion does not allocate; `gray` only refers to one or the
+        // other.
         cv::Mat gray;
-        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+        const bool converted = frame.channels() != 1;
+        if (!converted)
+            gray = frame;
+        else
+        {
+            TraceScope t("cvtColor", seq, frameId);
+            cv::cvtColor(frame, grayBuf, cv::COLOR_BGR2GRAY);
+            gray = grayBuf;
+        }
 
+        FrameRecordHeader meta{};
+        meta.frameId  = frameId;
+        meta.seq      = seq;
+        meta.stamp    = stamp;
+        meta.unixTime = unixTime;
+        meta.camera   = static_cast<uint32_t>(cam.index);
+
+        // The recorder keeps a reference unless told to copy; grayBuf is
+        // overwritten next frame.  Clips copy in push().
+        if (recording)
+        {
+            if (converted) recorder.pushCopy(meta, gray);
+            else           recorder.push(meta, gray);
+        }
+
+        // Calibration needs the whole frame; `next` still holds the last
+        // frame's sightings here
+        cv::Rect roi(0, 0, gray.cols, gray.rows);
+        if (roiMode && cam.calibrated)
+        {
+            if (fixedRig)
+                predictSightings(fixedCore, orbitSeen, stamp, next, expected);
+            else
+                predictSightings(dynamicCore, orbitSeen, stamp, next, expected);
+            roi = trackingRoi(expected, gray.size());
+        }
         image_u8_t img =
         {
-            gray.cols, gray.rows, gray.cols, gray.data
+            roi.width, roi.height, static_cast<int32_t>(gray.step[0]),
+            gray.ptr(roi.y) + roi.x
         };
 
-        auto detections = apriltag_detector_detect(detector, &img);
+        // Sensor to detector, live cameras only (replayed stamps are old)
+        if (liveCapture)
+            metrics.stage(Stage::Capture, static_cast<int64_t>((steadySeconds() - stamp) * 1e9));
+
+        zarray_t* detections;
+        {
+            TraceScope t("detect", seq, frameId);
+            StageTimer m(Stage::Detect);
+            PerfScope  p(perf, summary.perf[static_cast<int>(Stage::Detect)]);
+            detections = apriltag_detector_detect(detector, &img);
+        }
+        if (roi.x != 0 || roi.y != 0)
+            offsetDetections(detections, roi.tl());
+        stats.detections.record(zarray_size(detections));
 
         // Collect calibration correspondences
-        std::vector<cv::Point2f> calibImg;
-        std::vector<cv::Point3f> calibObj;
+        calibImg.clear();
+        calibObj.clear();
 
-        // Reset visibility each frame
-        TagState new0, new1;
-        TagState prev0, prev1;
+        // Gate against the fused track; only this frame's sightings go in next
         {
-            std::lock_guard<std::mutex> lock(poseMutex);
-            new0 = tag0State;  new0.visible = false;
-            new1 = tag1State;  new1.visible = false;
-            new0.corners.clear();
-            new1.corners.clear();
-            prev0 = tag0State;
-            prev1 = tag1State;
+            ProfiledLock lock(poseMutex, LockSite::PoseGate);
+            prev      = trackState;
+            orbitSeen = orbit;
         }
+        next.clearVisibility();
+
+        const double poseStart = steadySeconds();
+        PerfSample   posePerf;
+        perf.read(posePerf);
+        const uint64_t solvesBefore = poseCache.solves(), hitsBefore = poseCache.hits();
+        if (fixedRig)
+            trackDetections(fixedCore, poseCache, cam, detections, prev, orbitSeen, stamp, next,
+                            calibImg, calibObj, seq, frameId);
+        else
+            trackDetections(dynamicCore, poseCache, cam, detections, prev, orbitSeen, stamp, next,
+                            calibImg, calibObj, seq, frameId);
+        summary.solves    += poseCache.solves() - solvesBefore;
+        summary.cacheHits += poseCache.hits() - hitsBefore;
+        stats.poseSolves.fetch_add(poseCache.solves() - solvesBefore, std::memory_order_relaxed);
+        stats.poseCacheHits.fetch_add(poseCache.hits() - hitsBefore, std::memory_order_relaxed);
+
+        metrics.stage(Stage::Pose, static_cast<int64_t>((steadySeconds() - poseStart) * 1e9));
+        perf.addSince(posePerf, summary.perf[static_cast<int>(Stage::Pose)]);
 
-        for (int i = 0; i < zarray_size(detections); ++i)
+        // Run calibration if not done yet
+        if (!cam.calibrated)
         {
-            apriltag_detection_t* det;
-            zarray_get(detections, i, &det);
+            TraceScope t("calibrate", seq, frameId);
+            if (calibrate(cam, calibImg, calibObj))
+            {
+                dynamicCore.setCalibration(cam.R_wc, cam.t_wc);
+                fixedCore.setCalibration(cam.R_wc, cam.t_wc);
+                poseCache.clear();   // cached world poses used the old calibration
+            }
+        }
 
-            // Skip very low-quality detections early
-            if (det->hamming > 1) continue;
+        // Merge this camera's sightings into the shared world track
+        {
+            TraceScope t("fuse", seq, frameId);
+            StageTimer m(Stage::Fuse);
+            PerfScope  p(perf, summary.perf[static_cast<int>(Stage::Fuse)]);
+            ProfiledLock lock(poseMutex, LockSite::PoseFuse);
+            cam.observed = next;
+            fusion.update(cam.index, stamp, next, trackState);
+            if (config.orbitModel && next.visible[endMassSlot] && trackState.visible[satelliteSlot])
+                orbit.update(stamp, trackState.pose[satelliteSlot], trackState.pose[endMassSlot]);
+            out       = trackState;
+            orbitSeen = orbit;
+        }
+
+        apriltag_detections_destroy(detections);
 
-            // --- Calibration tag corners ---
-            if (worldTagCorners.count(det->id))
+        if (clips.enabled())
+        {
+            for (size_t k = 0; k < out.size(); ++k)
             {
-                for (int k = 0; k < 4; ++k)
-                {
-                    calibImg.emplace_back(det->p[k][0], det->p[k][1]);
-                    calibObj.push_back(worldTagCorners[det->id][k]);
-                }
+                if (prev.visible[k] && !out.visible[k])
+                    clips.trigger(ClipTrigger::TagLost);
+                else if (out.visible[k] && out.confidence[k] < config.clipTriggerConf &&
+                         (!prev.visible[k] || prev.confidence[k] >= config.clipTriggerConf))
+                    clips.trigger(ClipTrigger::ConfidenceDrop);
             }
+            clips.push(meta, gray, out);
+        }
 
-            // --- Tracking tags ---
-            if (calibrated &&
-                (det->id == TRACK_TAG0 || det->id == TRACK_TAG1))
+        if (trajLog.isOpen())
+        {
+            const uint16_t camFlags = static_cast<uint16_t>(cam.index << TRAJ_CAMERA_SHIFT);
+            for (size_t k = 0; k < out.size(); ++k)
             {
-                std::vector<cv::Point2f> imgPts;
-                for (int k = 0; k < 4; ++k)
-                    imgPts.emplace_back(det->p[k][0], det->p[k][1]);
-
-                cv::Mat rvec, tvec;
-                cv::solvePnP(trackObj, imgPts, K, D, rvec, tvec);
-
-                // Confidence score (uses rvec/tvec from solvePnP)
-                double conf = computeConfidence(det, rvec, tvec, trackObj, imgPts);
-
-                // World position
-                auto world = camToWorld(tvec);
-
-                // Yaw from rotation matrix
-                cv::Mat R;
-                cv::Rodrigues(rvec, R);
-                double yaw = std::atan2(R.at<double>(1, 0),
-                                        R.at<double>(0, 0)) * 180.0 / CV_PI;
-
-                TagState ts;
-                ts.pose       = { world.x, world.y, yaw };
-                ts.confidence = conf;
-                ts.visible    = true;
-                ts.corners    = imgPts;
-
-                // Hard reject low-confidence detections: they are a major source
-                // of repeated "fixed-value" spikes when a false tag pose appears.
-                if (ts.confidence < MIN_TRACK_CONF) continue;
-
-                if (det->id == TRACK_TAG0)
-                {
-                    if (isPlausibleJump(prev0, ts)) new0 = ts;
-                }
-                else
-                {
-                    if (isPlausibleJump(prev1, ts)) new1 = ts;
-                }
+                TrajRow row;
+                row.seq   = frameId;
+                row.stamp = unixTime;
+                row.x     = static_cast<float>(out.pose[k].x);
+                row.y     = static_cast<float>(out.pose[k].y);
+                row.yaw   = static_cast<float>(out.pose[k].yaw);
+                row.conf  = static_cast<float>(out.confidence[k]);
+                row.tag   = static_cast<uint16_t>(tags.trackIds[k]);
+                row.flags = camFlags | (out.visible[k] ? TRAJ_VISIBLE : 0);
+                trajLog.append(row);
             }
         }
 
-        // Run calibration if not done yet
-        if (!calibrated)
-            calibrate(calibImg, calibObj);
-
+        // --- JSON output (stderr stays clean for logs) ---
+        if (logger.sample(LogChannel::Pose))
         {
-            std::lock_guard<std::mutex> lock(poseMutex);
-            tag0State = new0;
-            tag1State = new1;
+            TraceScope t("json_write", seq, frameId);
+            auto ts_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+
+            auto rec = logger.begin(LogChannel::Pose);
+            rec.appendf("{\"ts\":%lld,\"frame\":%llu,\"camera\":\"%s\"",
+                        static_cast<long long>(ts_ns),
+                        static_cast<unsigned long long>(frameId), cam.id.c_str());
+            for (size_t k = 0; k < out.size(); ++k)
+                appendTagJson(rec, tags.trackNames[k], out, static_cast<int>(k));
+            rec.appendf("}");
+            logger.commit(rec);
         }
 
-        apriltag_detections_destroy(detections);
+        ++summary.frames;
+        for (size_t k = 0; k < next.size(); ++k)
+        {
+            if (!next.visible[k]) continue;
+            ++summary.seen[k];
+            summary.confSum[k] += next.confidence[k];
+            metrics.confidence(next.confidence[k]);
+        }
+        const double now = steadySeconds();
+        if (now - summary.start >= SUMMARY_PERIOD_S)
+        {
+            logSummary(cam, summary, now, orbitSeen.locked(stamp) ? &orbitSeen : nullptr);
+            summary.reset(now, tags.trackCount());
+        }
 
-        // --- JSON output (stderr stays clean for logs) ---
-        auto ts_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-            std::chrono::steady_clock::now().time_since_epoch()).count();
+        // Subscribers (bridge contract, --publish, GUI stream) are served
+        // by the publisher thread.
+        {
+            TraceScope t("post", seq, frameId);
+            publisher.post(frameId, unixTime, cam.index, out);
+        }
 
-        TagState s0, s1;
+        stats.processed.fetch_add(1, std::memory_order_relaxed);
+        if (ALLOC_TRACKING)
         {
-            std::lock_guard<std::mutex> lock(poseMutex);
-            s0 = tag0State;
-            s1 = tag1State;
+            const AllocCounts a = threadAllocs();
+            stats.allocs.fetch_add(a.count - allocsBefore.count, std::memory_order_relaxed);
+            stats.allocBytes.fetch_add(a.bytes - allocsBefore.bytes, std::memory_order_relaxed);
+
+            if (allocStrictAfterWarmup && cam.calibrated && ++warmFrames == ALLOC_WARMUP_FRAMES)
+            {
+                logInfo("%s: alloc-strict armed, the next allocation aborts", cam.id.c_str());
+                allocStrict(true);
+            }
         }
+        cam.processedSeq = seq;
+    }
+}
+
+// ============================================================
+// ANNOTATED VIEW
+//
+// Shared by the OpenCV windows and the MJPEG preview.  Takes a reference
+// to a camera's latest frame (no pixel copy under frameMutex), decimates
+// it by a whole factor into a reused buffer and draws the overlay there.
+// ============================================================
+
+// Overlay colour per track slot (BGR); wraps for larger tag sets
+static const cv::Scalar TAG_COLOURS[] =
+{
+    {0, 255,   0}, {0, 100, 255}, {255, 100, 0}, {255, 0, 255},
+    {0, 255, 255}, {255, 255, 0}, {128, 0, 255}, {0, 128, 128}
+};
 
-        std::cout
-            << "{"
-            << "\"ts\":"    << ts_ns
-            << ",\"frame\":" << frameCounter
-            << ","           << tagJson("tag0", s0)
-            << ","           << tagJson("tag1", s1)
-            << "}\n";
+static std::string windowName(const CameraContext& cam)
+{
+    return "Tracking " + cam.id;
+}
+
+// Per-camera display state, reused across ticks
+struct CameraView
+{
+    std::string window;
+    cv::Mat     gray;       // decimated replay frame before colour conversion
+    cv::Mat     display;    // decimated BGR frame the overlay is drawn on
+    TrackSet    ts, seen;
+    uint64_t    shownSeq      = 0;
+    uint64_t    lastProcessed = 0;
+    double      lastAt        = 0.0;
+    double      fps           = 0.0;   // tracked frames per second, smoothed
+    LatencyMark frameMark;             // Stage::Frame counts at markAt
+    double      markAt        = 0.0;
+    double      frameP50Ms    = NAN;   // over the last summary period
+    double      frameP99Ms    = NAN;
+};
 
-        // Forward bridge contract when both tracking tags are visible.
-        if (s0.visible && s1.visible)
+// Draw one camera's view into view.display, at most maxWidth wide: fused
+// poses as text, this camera's own detections as borders, tracking rate
+// and latency.  False when there is no new frame since the last call.
+static bool renderView(CameraContext& cam, CameraView& view, double now, int maxWidth)
+{
+    const uint64_t processed = metrics.camera(cam.index).processed.load(std::memory_order_relaxed);
+    if (view.lastAt > 0.0 && now > view.lastAt)
+    {
+        const double fps = (processed - view.lastProcessed) / (now - view.lastAt);
+        view.fps = view.fps > 0.0 ? 0.8 * view.fps + 0.2 * fps : fps;
+    }
+    view.lastProcessed = processed;
+    view.lastAt        = now;
+
+    // Frame time over the last summary period, not the whole run
+    if (now - view.markAt >= SUMMARY_PERIOD_S)
+    {
+        view.frameP50Ms = metrics.stageQuantileSince(Stage::Frame, view.frameMark, 0.50) * 1e3;
+        view.frameP99Ms = metrics.stageQuantileSince(Stage::Frame, view.frameMark, 0.99) * 1e3;
+        metrics.stageMark(Stage::Frame, view.frameMark);
+        view.markAt = now;
+    }
+
+    cv::Mat  frame;
+    uint64_t seq;
+    {
+        TraceScope t("vis_grab");
+        ProfiledLock lock(cam.frameMutex, LockSite::FrameVis);
+        frame = cam.latestFrame;   // publishers replace, never modify
+        seq   = cam.latestSeq;
+    }
+    if (frame.empty() || seq == view.shownSeq) return false;
+    view.shownSeq = seq;
+
+    const int step = (frame.cols + maxWidth - 1) / maxWidth;
+    const cv::Size size(frame.cols / step, frame.rows / step);
+    {
+        TraceScope t("view_decimate", seq);
+        if (frame.channels() == 1)
         {
-            auto now = std::chrono::system_clock::now();
-            double unixSec = std::chrono::duration<double>(now.time_since_epoch()).count();
-            sendDetectorContract(frameCounter.load(), unixSec, s0, s1);
+            if (step > 1) cv::resize(frame, view.gray, size, 0, 0, cv::INTER_NEAREST);
+            cv::cvtColor(step > 1 ? view.gray : frame, view.display, cv::COLOR_GRAY2BGR);
         }
+        else if (step > 1)
+            cv::resize(frame, view.display, size, 0, 0, cv::INTER_NEAREST);
+        else
+            frame.copyTo(view.display);
+    }
+
+    {
+        ProfiledLock lock(poseMutex, LockSite::PoseVis);
+        view.ts   = trackState;
+        view.seen = cam.observed;
+    }
+
+    TraceScope t("view_draw", seq);
+    cv::Mat& img = view.display;
+    const TrackSet& ts   = view.ts;
+    const TrackSet& seen = view.seen;
+
+    // Sizes below were chosen for a 2028-pixel-wide display
+    const double fs    = std::max(0.4, size.width / 2028.0);
+    const int    line  = static_cast<int>(50 * fs);
+    const int    thick = std::max(1, static_cast<int>(std::lround(2 * fs)));
+    const float  sx    = static_cast<float>(size.width)  / frame.cols;
+    const float  sy    = static_cast<float>(size.height) / frame.rows;
+
+    char txt[160];
+    const int nColours = static_cast<int>(std::size(TAG_COLOURS));
+    const int nTags    = static_cast<int>(ts.size());
+    for (int k = 0; k < nTags; ++k)
+    {
+        const cv::Scalar& colour = TAG_COLOURS[k % nColours];
+        const std::string& name  = tags.trackNames[k];
+
+        std::snprintf(txt, sizeof(txt), "%c%s x=%.4f y=%.4f yaw=%d conf=%.2f%s",
+                      std::toupper(name[0]), name.c_str() + 1,
+                      ts.pose[k].x, ts.pose[k].y, static_cast<int>(ts.pose[k].yaw),
+                      ts.confidence[k], ts.visible[k] ? "" : " [lost]");
+        cv::putText(img, txt, {static_cast<int>(40 * fs), line * (k + 1)},
+                    cv::FONT_HERSHEY_SIMPLEX, 1.1 * fs, colour, thick);
+
+        if (!seen.visible[k]) continue;
+        cv::Point corners[4];
+        for (int c = 0; c < 4; ++c)
+            corners[c] = { static_cast<int>(std::lround(seen.corners[k][c].x * sx)),
+                           static_cast<int>(std::lround(seen.corners[k][c].y * sy)) };
+        const cv::Point* poly = corners;
+        const int        npts = 4;
+        cv::polylines(img, &poly, &npts, 1, true, colour, 2 * thick, cv::LINE_AA);
+        cv::putText(img, name, corners[0] + cv::Point(0, -line / 5),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.9 * fs, colour, thick, cv::LINE_AA);
+    }
+
+    // Calibration status, tracking rate and per-frame latency
+    cv::putText(img,
+        cam.calibrated ? "CAL OK" : "CALIBRATING...",
+        {static_cast<int>(40 * fs), line * (nTags + 1)},
+        cv::FONT_HERSHEY_SIMPLEX, fs,
+        cam.calibrated ? cv::Scalar(0,255,100) : cv::Scalar(0,100,255), thick);
+
+    std::snprintf(txt, sizeof(txt), "%.1f fps  frame %.1f / %.1f ms (p50 / p99, last %.0f s)",
+                  view.fps, view.frameP50Ms, view.frameP99Ms, SUMMARY_PERIOD_S);
+    cv::putText(img, txt, {static_cast<int>(40 * fs), line * (nTags + 2)},
+                cv::FONT_HERSHEY_SIMPLEX, fs, cv::Scalar(255, 255, 255), thick);
+    return true;
+}
+
+// Sleep until `next` (steady clock) advances by one period, in steps short
+// enough to notice shutdown; after a slow tick start over rather than
+// catch up
+static void waitTick(double& next, double period)
+{
+    next += period;
+    if (next < steadySeconds()) next = steadySeconds();
+    while (running)
+    {
+        const double wait = next - steadySeconds();
+        if (wait <= 0.0) break;
+        std::this_thread::sleep_for(std::chrono::duration<double>(std::min(wait, 0.1)));
     }
 }
 
 // ============================================================
 // VISUALIZATION THREAD
+//
+// OpenCV windows, redrawn at --vis-hz and never faster.  A window that
+// is minimised or closed is not redrawn, where the HighGUI backend
+// reports it; backends that cannot report it always draw.  Not started
+// with --headless.
 // ============================================================
 
-void visThread()
+static void showCamera(CameraContext& cam, CameraView& view, double now)
 {
-    cv::namedWindow("Tracking", cv::WINDOW_NORMAL);
-    cv::resizeWindow("Tracking", DISPLAY_W, DISPLAY_H);
+    // 0 = minimised or closed; -1 = the backend cannot tell, so draw
+    if (cv::getWindowProperty(view.window, cv::WND_PROP_VISIBLE) == 0.0) return;
 
+    const cv::Size before = view.display.size();
+    if (!renderView(cam, view, now, VIS_MAX_WIDTH)) return;
+    if (view.display.size() != before)
+        cv::resizeWindow(view.window, view.display.cols, view.display.rows);
+
+    TraceScope t("vis_imshow", view.shownSeq);
+    cv::imshow(view.window, view.display);
+}
+
+void visThread(double hz)
+{
+    traceThread("vis");
+    std::vector<CameraView> views(cameras.size());
+    for (size_t c = 0; c < cameras.size(); ++c)
+    {
+        views[c].window = windowName(*cameras[c]);
+        cv::namedWindow(views[c].window, cv::WINDOW_NORMAL);
+    }
+
+    const double period = 1.0 / std::max(hz, 0.1);
+    double next = steadySeconds();
+    while (running)
+    {
+        const double now = steadySeconds();
+        for (size_t c = 0; c < cameras.size(); ++c)
+            showCamera(*cameras[c], views[c], now);
+
+        // Sleep in waitKey, which also services the windows
+        next += period;
+        const double wait = next - steadySeconds();
+        if (wait < 0.0) next = steadySeconds();
+        if (cv::waitKey(std::max(1, static_cast<int>(wait * 1000.0))) == 'q') running = false;
+    }
+}
+
+// ============================================================
+// PREVIEW THREAD  (--preview-port)
+//
+// The annotated view, downscaled to PREVIEW_MAX_WIDTH and JPEG-encoded
+// at --preview-hz, served as MJPEG for checking the camera from a
+// laptop.  The thread runs at the lowest CPU priority and only renders
+// a camera while a client is watching it.
+// ============================================================
+
+void previewThread(double hz)
+{
+    traceThread("preview");
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), PREVIEW_NICE) != 0)
+        logWarn("Preview thread: cannot lower priority");
+
+    std::vector<CameraView> views(cameras.size());
+    std::vector<uint8_t>    jpeg;
+    const std::vector<int>  params = { cv::IMWRITE_JPEG_QUALITY, PREVIEW_JPEG_QUALITY };
+
+    const double period = 1.0 / std::max(hz, 0.5);
+    double next = steadySeconds();
     while (running)
     {
-        cv::Mat frame;
+        const double now = steadySeconds();
+        for (size_t c = 0; c < cameras.size(); ++c)
         {
-            std::lock_guard<std::mutex> lock(frameMutex);
-            if (latestFrame.empty()) continue;
-            frame = latestFrame.clone();
+            if (!previewServer.wanted(c)) continue;
+            if (!renderView(*cameras[c], views[c], now, PREVIEW_MAX_WIDTH)) continue;
+            {
+                TraceScope t("preview_encode", views[c].shownSeq);
+                cv::imencode(".jpg", views[c].display, jpeg, params);
+            }
+            previewServer.publish(c, jpeg);
         }
+        waitTick(next, period);
+    }
+}
+
+// ============================================================
+// CONTROL CHANNEL  (--control <spec>, control.hpp)
+//
+//   status                    current runtime settings
+//   roi on|off                detection window around the tracked tags
+//   decimate <x>              AprilTag quad_decimate (1 - 8)
+//   record start <file>       grey frames to a frame file, as --record
+//   record stop
+//   recalibrate [camera]      redo calibration; every camera by default
+//   publish-hz <hz>           cap every subscriber, 0 = their own rates
+//   metrics                   counters and stage latencies, one JSON line
+//
+// Commands run on the control thread.  Tracking-thread settings are
+// stored in `control` and picked up between frames.
+// ============================================================
 
-        const int srcW = frame.cols;
-        const int srcH = frame.rows;
-        cv::resize(frame, frame, cv::Size(DISPLAY_W, DISPLAY_H));
+constexpr double CONTROL_APPLY_TIMEOUT_S = 2.0;
 
-        TagState s0, s1;
+// Publish the ControlState stores made so far and wait until every
+// tracking thread has taken them, i.e. has finished any frame that used
+// the old values.  False on timeout or shutdown.
+static bool applyControl()
+{
+    const uint64_t gen = control.generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+    const double deadline = steadySeconds() + CONTROL_APPLY_TIMEOUT_S;
+    for (auto& cam : cameras)
+    {
+        while (cam->controlSeen.load(std::memory_order_acquire) < gen)
         {
-            std::lock_guard<std::mutex> lock(poseMutex);
-            s0 = tag0State;
-            s1 = tag1State;
+            if (!running || steadySeconds() > deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
+    }
+    return true;
+}
 
-        auto drawTag = [&](const TagState& ts, const std::string& label,
-                           int y, cv::Scalar colour)
-        {
-            std::string vis = ts.visible ? "" : " [lost]";
-            std::string txt = label
-                + " x=" + std::to_string(ts.pose.x).substr(0,6)
-                + " y=" + std::to_string(ts.pose.y).substr(0,6)
-                + " yaw=" + std::to_string((int)ts.pose.yaw)
-                + " conf=" + std::to_string(ts.confidence).substr(0,4)
-                + vis;
-            cv::putText(frame, txt, {40, y},
-                        cv::FONT_HERSHEY_SIMPLEX, 1.1, colour, 2);
-        };
+static std::string controlStatus()
+{
+    std::string out;
+    appendf(out, "ok roi %s, decimate %.2f, recording %s, publish-hz %.1f, calibrated",
+            control.roi ? "on" : "off", control.quadDecimate.load(),
+            control.recording ? "on" : "off", publisher.rateLimit());
+    for (const auto& cam : cameras)
+        appendf(out, " %s=%d", cam->id.c_str(), cam->calibrated ? 1 : 0);
+    return out;
+}
 
-        drawTag(s0, "Tag0", 50,  {0, 255,   0});
-        drawTag(s1, "Tag1", 100, {0, 100, 255});
+static std::string controlMetrics()
+{
+    std::string out = "{\"cameras\":{";
+    for (size_t c = 0; c < cameras.size(); ++c)
+    {
+        const CameraMetrics& m = metrics.camera(static_cast<int>(c));
+        appendf(out, "%s\"%s\":{\"captured\":%llu,\"processed\":%llu,\"skipped\":%llu,"
+                "\"pose_solves\":%llu,\"pose_cache_hits\":%llu}",
+                c ? "," : "", m.id.c_str(),
+                static_cast<unsigned long long>(m.captured.load()),
+                static_cast<unsigned long long>(m.processed.load()),
+                static_cast<unsigned long long>(m.skipped.load()),
+                static_cast<unsigned long long>(m.poseSolves.load()),
+                static_cast<unsigned long long>(m.poseCacheHits.load()));
+    }
+    out += "},\"stage_ms\":{";
+    const char* sep = "";
+    for (Stage s : { Stage::Queue, Stage::Capture, Stage::Detect, Stage::Pose, Stage::Fuse, Stage::Frame,
+                     Stage::Publish })
+    {
+        const double p50 = metrics.stageQuantile(s, 0.50), p99 = metrics.stageQuantile(s, 0.99);
+        if (std::isnan(p50)) continue;
+        appendf(out, "%s\"%s\":{\"p50\":%.3f,\"p99\":%.3f}", sep, stageName(s), p50 * 1e3, p99 * 1e3);
+        sep = ",";
+    }
+    appendf(out, "},\"publisher_dropped\":%llu,\"logger_dropped\":%llu,\"recorder_dropped\":%llu}",
+            static_cast<unsigned long long>(publisher.dropped()),
+            static_cast<unsigned long long>(logger.dropped()),
+            static_cast<unsigned long long>(recorder.dropped()));
+    return out;
+}
 
-        auto drawTagBorder = [&](const TagState& ts,
-                                 const std::string& label,
-                                 const cv::Scalar& colour)
+static std::string controlCommand(const std::vector<std::string>& w)
+{
+    const std::string& cmd = w[0];
+
+    if (cmd == "status" && w.size() == 1)
+        return controlStatus();
+
+    if (cmd == "metrics" && w.size() == 1)
+        return controlMetrics();
+
+    if (cmd == "roi" && w.size() == 2 && (w[1] == "on" || w[1] == "off"))
+    {
+        control.roi = w[1] == "on";
+        applyControl();
+        return "ok roi " + w[1];
+    }
+
+    if (cmd == "decimate" && w.size() == 2)
+    {
+        TrackerConfig probe;   // same range check as --quad-decimate
+        if (!setConfigValue(probe, "quad_decimate", w[1]))
+            return "error: quad_decimate must be 1 - 8";
+        control.quadDecimate = probe.detector.quadDecimate;
+        applyControl();
+        return "ok decimate " + w[1];
+    }
+
+    if (cmd == "record" && w.size() == 3 && w[1] == "start")
+    {
+        if (control.recording || recorder.isOpen())
+            return "error: already recording";
+        if (!recorder.open(w[2], SENSOR_W / config.resolutionDivider,
+                           SENSOR_H / config.resolutionDivider, 1))
+            return "error: cannot open " + w[2];
+        control.recording = true;
+        applyControl();
+        return "ok recording to " + w[2];
+    }
+
+    if (cmd == "record" && w.size() == 2 && w[1] == "stop")
+    {
+        if (!control.recording)
+            return "error: not recording";
+        control.recording = false;
+
+        // No tracking thread may be inside push() when the file closes
+        if (!applyControl())
+            return "error: tracking threads did not acknowledge, the file closes at exit";
+        recorder.close();
+        std::string out;
+        appendf(out, "ok %llu frames, %llu dropped",
+                static_cast<unsigned long long>(recorder.written()),
+                static_cast<unsigned long long>(recorder.dropped()));
+        return out;
+    }
+
+    if (cmd == "recalibrate" && w.size() <= 2)
+    {
+        int n = 0;
+        for (auto& cam : cameras)
         {
-            if (!ts.visible || ts.corners.size() != 4 || srcW <= 0 || srcH <= 0) return;
+            if (w.size() == 2 && cam->id != w[1]) continue;
+            cam->recalibrate = true;
+            ++n;
+        }
+        if (n == 0) return "error: no camera " + w[1];
+        applyControl();
+        return "ok recalibrating " + std::to_string(n) + " camera(s)";
+    }
+
+    if (cmd == "publish-hz" && w.size() == 2)
+    {
+        char* end;
+        const double hz = std::strtod(w[1].c_str(), &end);
+        if (*end != '\0' || !(hz >= 0.0))
+            return "error: publish-hz must be >= 0";
+        publisher.setRateLimit(hz);
+        return "ok publish-hz " + w[1];
+    }
+
+    return "error: unknown command (status, roi, decimate, record, recalibrate, publish-hz, metrics)";
+}
 
-            const float sx = static_cast<float>(DISPLAY_W) / static_cast<float>(srcW);
-            const float sy = static_cast<float>(DISPLAY_H) / static_cast<float>(srcH);
+// ============================================================
+// TRACKER LIFECYCLE
+// ============================================================
+
+std::shared_ptr<PoseHistory> poseHistory;
+
+static FrameFileReader          replay;
+static std::vector<std::thread> workers;
+static std::thread              vis;
+static std::thread              preview;
+static bool                     trackerStarted = false;
+
+bool parseTrackerArgs(int argc, char** argv, TrackerOptions& opts)
+{
+    // --profile <default|fast|precise>  preset settings (config.cpp)
+    // --config <file>     `name = value` settings, applied after the profile
+    // --<setting> <value> any config.hpp setting, e.g. --resolution-divider 4,
+    //                     applied last
+    // --record <file>   write every grey frame the tracker sees
+    // --replay <file>   track a recording instead of the cameras
+    // --clip-dir <dir>  keep a RAM ring and save clips around anomalies
+    // --traj-log <file> binary per-tag pose log (read with trajlog_dump)
+    // --pose-log-hz <hz>  JSON pose records per second (-1 every frame, 0 off)
+    // --log-level <debug|info|warn|error>
+    // --ws-port <port>    serve the GUI payload directly (no Python bridge)
+    // --ws-max-hz <hz>    per-client WebSocket rate cap (default 30)
+    // --publish <spec>    extra output subscriber, see publisher.hpp (repeatable)
+    // --headless          no OpenCV windows, HighGUI is never touched (alias --no-vis)
+    // --vis-hz <hz>       OpenCV window redraw rate (default 15)
+    // --preview-port <port>  annotated MJPEG preview on http://host:<port>/
+    // --preview-hz <hz>   preview frame rate (default 2)
+    // --trace <file.json> Chrome/Perfetto stage trace, written at exit / SIGUSR1
+    // --metrics-port <port>  Prometheus text on http://host:<port>/metrics
+    // --alloc-strict      abort if a tracking thread allocates after warm-up
+    // --perf-counters     cycles / IPC / cache and branch misses per stage in the summary
+    // --capture-thread    pull frames on a capture thread instead of the appsink callback
+    // --control <spec>    runtime commands over udp:// or unix:// (control.hpp)
+
+    // Profile, then config file, wherever they appear
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--profile" && !applyProfile(opts.config, argv[i + 1]))
+            return false;
+    }
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--config" && !loadConfigFile(opts.config, argv[i + 1]))
+            return false;
+    }
 
-            std::vector<cv::Point> scaled;
-            scaled.reserve(4);
-            for (const auto& p : ts.corners)
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if ((arg == "--profile" || arg == "--config") && i + 1 < argc)
+        {
+            ++i;
+            continue;
+        }
+        if (arg.compare(0, 2, "--") == 0 && i + 1 < argc)
+        {
+            std::string key = arg.substr(2);
+            std::replace(key.begin(), key.end(), '-', '_');
+            if (isConfigKey(key))
             {
-                scaled.emplace_back(
-                    static_cast<int>(std::lround(p.x * sx)),
-                    static_cast<int>(std::lround(p.y * sy)));
+                if (!setConfigValue(opts.config, key, argv[++i])) return false;
+                continue;
             }
+        }
+        if (arg == "--pose-log-hz" && i + 1 < argc)
+        {
+            logger.setRate(LogChannel::Pose, std::atof(argv[++i]));
+            continue;
+        }
+        if (arg == "--log-level" && i + 1 < argc)
+        {
+            const std::string level = argv[++i];
+            logger.setMinLevel(level == "debug" ? LogLevel::Debug :
+                               level == "warn"  ? LogLevel::Warn  :
+                               level == "error" ? LogLevel::Error : LogLevel::Info);
+            continue;
+        }
 
-            cv::polylines(frame, scaled, true, colour, 4, cv::LINE_AA);
-            cv::putText(frame, label, scaled[0] + cv::Point(0, -10),
-                        cv::FONT_HERSHEY_SIMPLEX, 0.9, colour, 2, cv::LINE_AA);
-        };
+        if      (arg == "--record"   && i + 1 < argc) opts.recordPath = argv[++i];
+        else if (arg == "--replay"   && i + 1 < argc) opts.replayPath = argv[++i];
+        else if (arg == "--clip-dir" && i + 1 < argc) opts.clipDir    = argv[++i];
+        else if (arg == "--traj-log" && i + 1 < argc) opts.trajPath   = argv[++i];
+        else if (arg == "--ws-port"  && i + 1 < argc) opts.wsPort     = std::atoi(argv[++i]);
+        else if (arg == "--ws-max-hz" && i + 1 < argc) opts.wsMaxHz    = std::atof(argv[++i]);
+        else if (arg == "--publish"  && i + 1 < argc) opts.publish.push_back(argv[++i]);
+        else if (arg == "--headless" || arg == "--no-vis") opts.visualise = false;
+        else if (arg == "--vis-hz"   && i + 1 < argc) opts.visHz      = std::atof(argv[++i]);
+        else if (arg == "--preview-port" && i + 1 < argc) opts.previewPort = std::atoi(argv[++i]);
+        else if (arg == "--preview-hz"   && i + 1 < argc) opts.previewHz   = std::atof(argv[++i]);
+        else if (arg == "--trace"    && i + 1 < argc) opts.tracePath  = argv[++i];
+        else if (arg == "--metrics-port" && i + 1 < argc) opts.metricsPort = std::atoi(argv[++i]);
+        else if (arg == "--alloc-strict")             opts.allocStrict = true;
+        else if (arg == "--perf-counters")            opts.perfCounters = true;
+        else if (arg == "--capture-thread")           opts.captureThread = true;
+        else if (arg == "--control"  && i + 1 < argc) opts.controlSpec = argv[++i];
+        else logWarn("Ignoring unknown option %s", arg.c_str());
+    }
+    return true;
+}
+
+bool startTracker(const TrackerOptions& opts)
+{
+    if (trackerStarted)
+    {
+        logError("Tracker already started in this process");
+        return false;
+    }
+    trackerStarted = true;
+    running = true;
+
+    if (!opts.tracePath.empty())
+        traceStart(opts.tracePath);
+
+    liveCapture            = opts.replayPath.empty();
+    allocStrictAfterWarmup = opts.allocStrict && ALLOC_TRACKING;
+    perfCountersOn         = opts.perfCounters;
+    if (opts.allocStrict && !ALLOC_TRACKING)
+        logWarn("--alloc-strict needs a -DTRACKER_ALLOC_TRACKING=ON build; ignored");
+
+    config = opts.config;
+    if (perfCountersOn && config.detector.nthreads > 1)
+    {
+        // The counters follow the tracking thread only; with AprilTag's
+        // workers detecting, `detect` would count a thread waiting on them
+        logWarn("--perf-counters: detector_threads %d -> 1 so detect is counted",
+                config.detector.nthreads);
+        config.detector.nthreads = 1;
+    }
+    if (config.cameras > static_cast<int>(std::size(CAMERA_SPECS)))
+    {
+        logError("cameras = %d, but CAMERA_SPECS has %zu entries",
+                 config.cameras, std::size(CAMERA_SPECS));
+        return false;
+    }
+    logConfig(config);
+
+    // Intrinsics are scaled to the capture size here
+    for (int i = 0; i < config.cameras; ++i)
+    {
+        auto cam = std::make_unique<CameraContext>();
+        initCamera(*cam, i, CAMERA_SPECS[i], config.resolutionDivider);
+        cameras.push_back(std::move(cam));
+    }
+
+    registerTags();
+
+    if (!config.bridge.empty() && !publisher.addSubscriber(config.bridge))
+        logWarn("Failed to initialize bridge sender (%s)", config.bridge.c_str());
+    for (const auto& spec : opts.publish)
+        if (!publisher.addSubscriber(spec)) return false;
+
+    // The pipeline string uses the computed literal values.
+    const int cam_w = SENSOR_W / config.resolutionDivider;
+    const int cam_h = SENSOR_H / config.resolutionDivider;
+
+    if (!opts.replayPath.empty())
+    {
+        if (!replay.open(opts.replayPath)) return false;
+        if (replay.header().width  != static_cast<uint32_t>(cam_w) ||
+            replay.header().height != static_cast<uint32_t>(cam_h))
+        {
+            logError("Recording is %ux%u, tracker expects %dx%d (--resolution-divider)",
+                     replay.header().width, replay.header().height, cam_w, cam_h);
+            return false;
+        }
+    }
+
+    if (!opts.recordPath.empty() && !recorder.open(opts.recordPath, cam_w, cam_h, 1))
+        return false;
+
+    // Control channel starting values; the tracking threads read them
+    // before their first frame
+    control.roi          = config.roi;
+    control.quadDecimate = config.detector.quadDecimate;
+    control.recording    = recorder.isOpen();
+
+    if (!opts.trajPath.empty() && !trajLog.open(opts.trajPath))
+        return false;
+
+    if (opts.wsPort > 0)
+    {
+        if (!guiServer.start(opts.wsPort, opts.wsMaxHz)) return false;
+        publisher.addLocalSink(publishGui);
+    }
 
-        drawTagBorder(s0, "tag0", {0, 255, 0});
-        drawTagBorder(s1, "tag1", {0, 100, 255});
+    if (opts.historyRows > 0)
+    {
+        auto history = std::make_shared<PoseHistory>(opts.historyRows, tags.trackCount());
+        poseHistory  = history;
+        publisher.addLocalSink([history](const PoseSnapshot& snap) { history->append(snap); });
+    }
+
+    std::vector<std::string> cameraIds;
+    for (const auto& cam : cameras) cameraIds.push_back(cam->id);
+
+    // Recording is always on; the endpoint only formats on request
+    metrics.init(cameraIds);
+    publisher.addLocalSink(recordPublished);
+    metrics.addCounter("vision_publisher_dropped_total", "Snapshots dropped on a full publisher ring",
+                       [] { return publisher.dropped(); });
+    metrics.addCounter("vision_logger_dropped_total", "Log records dropped on a full logger ring",
+                       [] { return logger.dropped(); });
+    if (opts.metricsPort > 0 && !metrics.serve(opts.metricsPort))
+        return false;
 
-        // Calibration status indicator
-        cv::putText(frame,
-            calibrated ? "CAL OK" : "CALIBRATING...",
-            {40, 150},
-            cv::FONT_HERSHEY_SIMPLEX, 1.0,
-            calibrated ? cv::Scalar(0,255,100) : cv::Scalar(0,100,255), 2);
+    publisher.start(tags.trackIds, satelliteSlot, endMassSlot, cameraIds);
+
+    if (!opts.clipDir.empty())
+    {
+        const size_t pre  = static_cast<size_t>(CLIP_PRE_S  * CLIP_EXPECTED_FPS);
+        const size_t post = static_cast<size_t>(CLIP_POST_S * CLIP_EXPECTED_FPS);
+        if (!clips.open(opts.clipDir, cam_w, cam_h, 1, pre + post, post, tags.trackIds))
+            return false;
+    }
+
+    for (auto& cam : cameras)
+    {
+        if (!opts.replayPath.empty()) break;
+
+        std::string pipeline = cameraPipeline(*cam, cam_w, cam_h);
+
+        GError* err = nullptr;
+        cam->pipe = gst_parse_launch(pipeline.c_str(), &err);
+        if (!cam->pipe || err)
+        {
+            logError("GStreamer pipeline (%s): %s", cam->id.c_str(),
+                     err ? err->message : "unknown");
+            return false;
+        }
 
-        cv::imshow("Tracking", frame);
-        if (cv::waitKey(1) == 'q') running = false;
+        cam->sink = gst_bin_get_by_name(GST_BIN(cam->pipe), "sink");
+        if (!opts.captureThread)
+            connectSampleCallback(*cam);
+        gst_element_set_state(cam->pipe, GST_STATE_PLAYING);
     }
+
+    for (auto& cam : cameras)
+    {
+        if (opts.replayPath.empty() && opts.captureThread)
+            workers.emplace_back(captureThread, std::ref(*cam));
+        workers.emplace_back(trackingThread, std::ref(*cam));
+    }
+    if (!opts.replayPath.empty())
+        workers.emplace_back(replayThread, &replay);
+    if (clips.enabled())
+        workers.emplace_back(clipTriggerThread);
+    if (opts.visualise)
+        vis = std::thread(visThread, opts.visHz);
+
+    if (opts.previewPort > 0)
+    {
+        if (!previewServer.start(opts.previewPort, cameraIds)) return false;
+        preview = std::thread(previewThread, opts.previewHz);
+    }
+
+    if (!opts.controlSpec.empty() && !controlServer.start(opts.controlSpec, controlCommand))
+        return false;
+    return true;
+}
+
+void waitTracker()
+{
+    for (auto& t : workers) t.join();
+    workers.clear();
+    if (vis.joinable()) vis.join();
+    if (preview.joinable()) preview.join();
+}
+
+void stopTracker()
+{
+    running = false;
+    controlServer.stop();
+    for (auto& cam : cameras) cam->frameReady.notify_all();
+    waitTracker();
+
+    recorder.close();
+    clips.close();
+    trajLog.close();
+    publisher.stop();
+    guiServer.stop();
+    previewServer.stop();
+    metrics.stop();
+    if (poseHistory) poseHistory->wake();
+    traceStop();
+
+    for (auto& cam : cameras)
+    {
+        if (!cam->pipe) continue;
+        gst_element_set_state(cam->pipe, GST_STATE_NULL);
+        gst_object_unref(cam->sink);
+        gst_object_unref(cam->pipe);
+        cam->pipe = nullptr;
+        cam->sink = nullptr;
+    }
+}
+
+bool trackerRunning()
+{
+    return trackerStarted && running;
+}
+
+const std::vector<int>& trackedTagIds()
+{
+    return tags.trackIds;
+}
+
+std::string trackerCommand(const std::vector<std::string>& words)
+{
+    return words.empty() ? "error: empty command" : controlCommand(words);
+}
+
+TrackerSetup trackerSetup()
+{
+    return { CAMERA_SPECS[0], SENSOR_W / config.resolutionDivider,
+             SENSOR_H / config.resolutionDivider, config.tagSize, config.calibSquare };
 }
 
 // ============================================================
 // MAIN
 // ============================================================
 
+#ifndef TRACKER_NO_MAIN
+
+// SIGINT / SIGTERM stop the tracker the same way 'q' does, so recordings
+// and logs are closed properly; a second signal kills the process.
+static void onStopSignal(int sig)
+{
+    running = false;
+    std::signal(sig, SIG_DFL);
+}
+
 int main(int argc, char** argv)
 {
     gst_init(&argc, &argv);
 
-    if (!initUdpSender())
-    {
-        std::cerr << "[WARN] Failed to initialize UDP sender (127.0.0.1:9001)\n";
-    }
+    TrackerOptions opts;
+    if (!parseTrackerArgs(argc, argv, opts))
+        return 2;
 
-    // NOTE: resolution_divider is a C++ constexpr, not a GStreamer variable.
-    // The pipeline string must use the computed literal values.
-    const int cam_w = 4056 / resolution_divider;
-    const int cam_h = 3040 / resolution_divider;
+    logger.start();
 
-    std::string pipeline =
-        "libcamerasrc ! "
-        "video/x-raw,width=" + std::to_string(cam_w) +
-        ",height="           + std::to_string(cam_h) +
-        ",format=BGRx ! "
-        "videoconvert ! "
-        "video/x-raw,format=BGR ! "
-        "appsink name=sink max-buffers=1 drop=true";
+    std::signal(SIGINT,  onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
 
-    GError* err = nullptr;
-    auto pipe = gst_parse_launch(pipeline.c_str(), &err);
-    if (!pipe || err)
+    // A failed start may leave threads running; stopTracker joins them
+    if (!startTracker(opts))
     {
-        std::cerr << "[ERROR] GStreamer pipeline: "
-                  << (err ? err->message : "unknown") << "\n";
+        stopTracker();
+        logger.stop();
         return 1;
     }
 
-    auto sink = gst_bin_get_by_name(GST_BIN(pipe), "sink");
-    gst_element_set_state(pipe, GST_STATE_PLAYING);
-
-    std::thread cap  (captureThread, sink);
-    std::thread track(trackingThread);
-    std::thread vis  (visThread);
-
-    cap.join();
-    track.join();
-    vis.join();
+    waitTracker();
+    stopTracker();
 
-    gst_element_set_state(pipe, GST_STATE_NULL);
-    gst_object_unref(pipe);
-    if (udpSock >= 0) close(udpSock);
+    logger.stop();
     return 0;
 }
+#endif
@@ -0,0 +1,531 @@
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+#include <dirent.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "alloc_tracker.hpp"
+#include "async_logger.hpp"
+#include "trace.hpp"
+
+Metrics metrics;
+
+constexpr double METRICS_WINDOW_S    = 10.0;   // quantile / rate window rotation
+constexpr size_t METRICS_MAX_REQUEST = 4096;
+
+static const char* const STAGE_NAMES[] =
+{
+    "copy", "queue", "capture", "detect", "pose", "fuse", "frame", "publish"
+};
+
+static_assert(std::size(STAGE_NAMES) == static_cast<size_t>(Stage::Count),
+              "STAGE_NAMES out of step with Stage");
+
+static const char* const LOCK_LABELS[] =
+{
+    "lock=\"frame\",site=\"publish\"",
+    "lock=\"frame\",site=\"pickup\"",
+    "lock=\"frame\",site=\"vis\"",
+    "lock=\"pose\",site=\"gate\"",
+    "lock=\"pose\",site=\"fuse\"",
+    "lock=\"pose\",site=\"vis\"",
+};
+
+static_assert(std::size(LOCK_LABELS) == static_cast<size_t>(LockSite::Count),
+              "LOCK_LABELS out of step with LockSite");
+
+const char* stageName(Stage s)
+{
+    return STAGE_NAMES[static_cast<int>(s)];
+}
+
+static const double QUANTILES[] = { 0.5, 0.9, 0.99 };
+
+static double nowSeconds()
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void appendHeader(std::string& out, const char* name, const char* type, const char* help)
+{
+    appendf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// Prometheus label values: escape backslash, quote and newline
+static std::string labelValue(const std::string& s)
+{
+    std::string out;
+    for (char c : s)
+    {
+        if (c == '\\' || c == '"') { out += '\\'; out += c; }
+        else if (c == '\n')        out += "\\n";
+        else                       out += c;
+    }
+    return out;
+}
+
+// ============================================================
+// HISTOGRAMS
+// ============================================================
+
+int LatencyHistogram::bucketOf(int64_t ns)
+{
+    if (ns < 1024) return 0;
+    const int b   = 63 - __builtin_clzll(static_cast<uint64_t>(ns));
+    const int sub = static_cast<int>((ns >> (b - 3)) & (SUB - 1));
+    return std::min(1 + (b - 10) * SUB + sub, BUCKETS - 1);
+}
+
+double LatencyHistogram::bucketUpperNs(int i)
+{
+    if (i == 0) return 1024.0;
+    const int b   = 10 + (i - 1) / SUB;
+    const int sub = (i - 1) % SUB;
+    return std::ldexp(SUB + sub + 1.0, b - 3);
+}
+
+void LatencyHistogram::record(int64_t ns)
+{
+    if (ns < 0) ns = 0;
+    counts[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    sumNs.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+}
+
+void ValueHistogram::init(std::vector<double> upperBounds)
+{
+    bounds = std::move(upperBounds);
+    counts.reset(new std::atomic<uint64_t>[bounds.size() + 1]);
+    for (size_t i = 0; i <= bounds.size(); ++i) counts[i] = 0;
+    sumMilli = 0;
+}
+
+void ValueHistogram::record(double v)
+{
+    size_t i = 0;
+    while (i < bounds.size() && v > bounds[i]) ++i;
+    counts[i].fetch_add(1, std::memory_order_relaxed);
+    sumMilli.fetch_add(static_cast<uint64_t>(std::llround(std::max(0.0, v) * 1000.0)),
+                       std::memory_order_relaxed);
+}
+
+// Quantile of a LatencyHistogram's bucket counts, interpolated linearly
+// inside the bucket that holds it.  NaN when there is no data.
+static double quantileSeconds(const uint64_t* counts, double q)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < LatencyHistogram::BUCKETS; ++i) total += counts[i];
+    if (total == 0) return NAN;
+
+    const double target = q * static_cast<double>(total);
+    double cum = 0.0;
+    for (int i = 0; i < LatencyHistogram::BUCKETS; ++i)
+    {
+        if (counts[i] == 0) continue;
+        if (cum + counts[i] >= target)
+        {
+            const double lo   = i == 0 ? 0.0 : LatencyHistogram::bucketUpperNs(i - 1);
+            const double hi   = LatencyHistogram::bucketUpperNs(i);
+            const double frac = (target - cum) / counts[i];
+            return (lo + frac * (hi - lo)) * 1e-9;
+        }
+        cum += counts[i];
+    }
+    return LatencyHistogram::bucketUpperNs(LatencyHistogram::BUCKETS - 1) * 1e-9;
+}
+
+static void appendValueHistogram(std::string& out, const char* name, const std::string& labels,
+                                 const ValueHistogram& h)
+{
+    const std::string sep = labels.empty() ? "" : ",";
+    uint64_t cum = 0;
+    for (size_t i = 0; i < h.bounds.size(); ++i)
+    {
+        cum += h.counts[i].load(std::memory_order_relaxed);
+        appendf(out, "%s_bucket{%s%sle=\"%g\"} %llu\n", name, labels.c_str(), sep.c_str(),
+                h.bounds[i], static_cast<unsigned long long>(cum));
+    }
+    cum += h.counts[h.bounds.size()].load(std::memory_order_relaxed);
+    appendf(out, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, labels.c_str(), sep.c_str(),
+            static_cast<unsigned long long>(cum));
+    const std::string set = labels.empty() ? "" : "{" + labels + "}";
+    appendf(out, "%s_sum%s %.3f\n", name, set.c_str(), h.sumMilli.load() / 1000.0);
+    appendf(out, "%s_count%s %llu\n", name, set.c_str(), static_cast<unsigned long long>(cum));
+}
+
+// ============================================================
+// THREAD CPU  (/proc/self/task/<tid>/stat, utime + stime)
+// ============================================================
+
+static void appendThreadCpu(std::string& out)
+{
+    DIR* dir = opendir("/proc/self/task");
+    if (!dir) return;
+
+    const double tick = static_cast<double>(sysconf(_SC_CLK_TCK));
+
+    while (dirent* ent = readdir(dir))
+    {
+        if (ent->d_name[0] == '.') continue;
+
+        char path[64];
+        std::snprintf(path, sizeof(path), "/proc/self/task/%s/stat", ent->d_name);
+        FILE* f = std::fopen(path, "r");
+        if (!f) continue;   // thread exited
+        char buf[1024];
+        const size_t n = std::fread(buf, 1, sizeof(buf) - 1, f);
+        std::fclose(f);
+        buf[n] = '\0';
+
+        // "tid (comm) state ..." -- comm may contain spaces and ')'
+        char* open  = std::strchr(buf, '(');
+        char* close = std::strrchr(buf, ')');
+        if (!open || !close || close < open) continue;
+        const std::string comm(open + 1, close);
+
+        // utime / stime are fields 14 / 15, i.e. the 12th / 13th after comm
+        unsigned long long utime = 0, stime = 0;
+        if (std::sscanf(close + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+                        &utime, &stime) != 2)
+            continue;
+
+        appendf(out, "vision_thread_cpu_seconds_total{thread=\"%s\",tid=\"%s\"} %.2f\n",
+                labelValue(comm).c_str(), ent->d_name, (utime + stime) / tick);
+    }
+    closedir(dir);
+}
+
+// ============================================================
+// METRICS
+// ============================================================
+
+Metrics::~Metrics()
+{
+    stop();
+}
+
+void Metrics::init(const std::vector<std::string>& cameraIds)
+{
+    cameras_.clear();
+    for (const auto& id : cameraIds)
+    {
+        auto cam = std::make_unique<CameraMetrics>();
+        cam->id = id;
+        cam->detections.init({ 0, 1, 2, 3, 4, 6, 8, 12, 16 });
+        cameras_.push_back(std::move(cam));
+    }
+    confidence_.init({ 0.5, 0.6, 0.7, 0.8, 0.9, 0.95 });
+}
+
+void Metrics::addCounter(const std::string& name, const std::string& help,
+                         std::function<uint64_t()> read)
+{
+    counters_.push_back({ name, help, std::move(read) });
+}
+
+Metrics::Window Metrics::snapshot() const
+{
+    Window w;
+    w.at = nowSeconds();
+    w.latency.resize(static_cast<size_t>(LATENCY_COUNT) * LatencyHistogram::BUCKETS);
+    for (int h = 0; h < LATENCY_COUNT; ++h)
+        for (int i = 0; i < LatencyHistogram::BUCKETS; ++i)
+            w.latency[h * LatencyHistogram::BUCKETS + i] =
+                latency_[h].counts[i].load(std::memory_order_relaxed);
+    for (const auto& cam : cameras_)
+    {
+        w.captured.push_back(cam->captured.load(std::memory_order_relaxed));
+        w.processed.push_back(cam->processed.load(std::memory_order_relaxed));
+    }
+    w.published = published_.load(std::memory_order_relaxed);
+    return w;
+}
+
+double Metrics::stageQuantile(Stage s, double q) const
+{
+    uint64_t counts[LatencyHistogram::BUCKETS];
+    const LatencyHistogram& h = latency_[static_cast<int>(s)];
+    for (int i = 0; i < LatencyHistogram::BUCKETS; ++i)
+        counts[i] = h.counts[i].load(std::memory_order_relaxed);
+    return quantileSeconds(counts, q);
+}
+
+void Metrics::stageMark(Stage s, LatencyMark& out) const
+{
+    const LatencyHistogram& h = latency_[static_cast<int>(s)];
+    for (int i = 0; i < LatencyHistogram::BUCKETS; ++i)
+        out.counts[i] = h.counts[i].load(std::memory_order_relaxed);
+}
+
+double Metrics::stageQuantileSince(Stage s, const LatencyMark& mark, double q) const
+{
+    uint64_t delta[LatencyHistogram::BUCKETS];
+    const LatencyHistogram& h = latency_[static_cast<int>(s)];
+    for (int i = 0; i < LatencyHistogram::BUCKETS; ++i)
+        delta[i] = h.counts[i].load(std::memory_order_relaxed) - mark.counts[i];
+    return quantileSeconds(delta, q);
+}
+
+// One summary series: window quantiles, lifetime sum and count
+void Metrics::appendLatency(std::string& out, const char* name, const std::string& labels,
+                            int index, const Window& cur, const Window& base) const
+{
+    const size_t off = static_cast<size_t>(index) * LatencyHistogram::BUCKETS;
+    uint64_t delta[LatencyHistogram::BUCKETS];
+    uint64_t count = 0;
+    for (int i = 0; i < LatencyHistogram::BUCKETS; ++i)
+    {
+        delta[i] = cur.latency[off + i] - base.latency[off + i];
+        count   += cur.latency[off + i];
+    }
+    for (double q : QUANTILES)
+    {
+        const double v = quantileSeconds(delta, q);
+        if (std::isnan(v))
+            appendf(out, "%s{%s,quantile=\"%g\"} NaN\n", name, labels.c_str(), q);
+        else
+            appendf(out, "%s{%s,quantile=\"%g\"} %.6f\n", name, labels.c_str(), q, v);
+    }
+    appendf(out, "%s_sum{%s} %.6f\n", name, labels.c_str(), latency_[index].sumNs.load() * 1e-9);
+    appendf(out, "%s_count{%s} %llu\n", name, labels.c_str(),
+            static_cast<unsigned long long>(count));
+}
+
+std::string Metrics::render()
+{
+    const Window cur = snapshot();
+    const Window& base = older_.latency.empty() ? cur : older_;
+    const double span  = std::max(1e-3, cur.at - base.at);
+
+    std::string out;
+    out.reserve(16384);
+
+    appendHeader(out, "vision_frames_captured_total", "counter", "Frames handed to a tracking thread");
+    for (const auto& cam : cameras_)
+        appendf(out, "vision_frames_captured_total{camera=\"%s\"} %llu\n", cam->id.c_str(),
+                static_cast<unsigned long long>(cam->captured.load()));
+
+    appendHeader(out, "vision_frames_processed_total", "counter", "Frames tracked");
+    for (const auto& cam : cameras_)
+        appendf(out, "vision_frames_processed_total{camera=\"%s\"} %llu\n", cam->id.c_str(),
+                static_cast<unsigned long long>(cam->processed.load()));
+
+    appendHeader(out, "vision_frames_skipped_total", "counter",
+                 "Frames replaced before the tracking thread picked them up");
+    for (const auto& cam : cameras_)
+        appendf(out, "vision_frames_skipped_total{camera=\"%s\"} %llu\n", cam->id.c_str(),
+                static_cast<unsigned long long>(cam->skipped.load()));
+
+    appendHeader(out, "vision_pose_solves_total", "counter", "Tracking-tag poses solved with solvePnP");
+    for (const auto& cam : cameras_)
+        appendf(out, "vision_pose_solves_total{camera=\"%s\"} %llu\n", cam->id.c_str(),
+                static_cast<unsigned long long>(cam->poseSolves.load()));
+
+    appendHeader(out, "vision_pose_cache_hits_total", "counter",
+                 "Tracking-tag sightings that reused the last solve of a still tag");
+    for (const auto& cam : cameras_)
+        appendf(out, "vision_pose_cache_hits_total{camera=\"%s\"} %llu\n", cam->id.c_str(),
+                static_cast<unsigned long long>(cam->poseCacheHits.load()));
+
+    appendHeader(out, "vision_camera_fps", "gauge", "Captured frames per second (last 10-20 s)");
+    for (size_t c = 0; c < cameras_.size(); ++c)
+        appendf(out, "vision_camera_fps{camera=\"%s\"} %.2f\n", cameras_[c]->id.c_str(),
+                c < base.captured.size() ? (cur.captured[c] - base.captured[c]) / span : 0.0);
+
+    appendHeader(out, "vision_processed_fps", "gauge", "Tracked frames per second (last 10-20 s)");
+    for (size_t c = 0; c < cameras_.size(); ++c)
+        appendf(out, "vision_processed_fps{camera=\"%s\"} %.2f\n", cameras_[c]->id.c_str(),
+                c < base.processed.size() ? (cur.processed[c] - base.processed[c]) / span : 0.0);
+
+    appendHeader(out, "vision_published_fps", "gauge", "Snapshots published per second (last 10-20 s)");
+    appendf(out, "vision_published_fps %.2f\n", (cur.published - base.published) / span);
+
+    appendHeader(out, "vision_stage_seconds", "summary",
+                 "Pipeline stage latency; quantiles over the last 10-20 s");
+    for (int s = 0; s < static_cast<int>(Stage::Count); ++s)
+        appendLatency(out, "vision_stage_seconds", std::string("stage=\"") + STAGE_NAMES[s] + "\"",
+                      s, cur, base);
+
+    appendHeader(out, "vision_lock_wait_seconds", "summary",
+                 "Time to acquire frameMutex / poseMutex per call site");
+    for (int l = 0; l < static_cast<int>(LockSite::Count); ++l)
+        appendLatency(out, "vision_lock_wait_seconds", LOCK_LABELS[l], LOCK_WAIT + l, cur, base);
+
+    appendHeader(out, "vision_lock_hold_seconds", "summary",
+                 "Time frameMutex / poseMutex is held per call site");
+    for (int l = 0; l < static_cast<int>(LockSite::Count); ++l)
+        appendLatency(out, "vision_lock_hold_seconds", LOCK_LABELS[l], LOCK_HOLD + l, cur, base);
+
+    appendHeader(out, "vision_detections_per_frame", "histogram", "AprilTag detections per frame");
+    for (const auto& cam : cameras_)
+        appendValueHistogram(out, "vision_detections_per_frame",
+                             "camera=\"" + cam->id + "\"", cam->detections);
+
+    appendHeader(out, "vision_tag_confidence", "histogram", "Confidence of accepted tag sightings");
+    appendValueHistogram(out, "vision_tag_confidence", "", confidence_);
+
+    if (ALLOC_TRACKING)
+    {
+        appendHeader(out, "vision_tracking_allocs_total", "counter",
+                     "operator new calls on the tracking thread");
+        for (const auto& cam : cameras_)
+            appendf(out, "vision_tracking_allocs_total{camera=\"%s\"} %llu\n", cam->id.c_str(),
+                    static_cast<unsigned long long>(cam->allocs.load()));
+
+        appendHeader(out, "vision_tracking_alloc_bytes_total", "counter",
+                     "Bytes requested through operator new on the tracking thread");
+        for (const auto& cam : cameras_)
+            appendf(out, "vision_tracking_alloc_bytes_total{camera=\"%s\"} %llu\n", cam->id.c_str(),
+                    static_cast<unsigned long long>(cam->allocBytes.load()));
+    }
+
+    for (const auto& c : counters_)
+    {
+        appendHeader(out, c.name.c_str(), "counter", c.help.c_str());
+        appendf(out, "%s %llu\n", c.name.c_str(), static_cast<unsigned long long>(c.read()));
+    }
+
+    appendHeader(out, "vision_thread_cpu_seconds_total", "counter", "CPU time (user + system) per thread");
+    appendThreadCpu(out);
+
+    return out;
+}
+
+bool Metrics::serve(int port)
+{
+    stop();
+
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0)
+    {
+        logError("Metrics: socket() failed: %s", std::strerror(errno));
+        return false;
+    }
+
+    int one = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listenFd_, 8) < 0)
+    {
+        logError("Metrics: cannot listen on port %d: %s", port, std::strerror(errno));
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0)
+    {
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    older_  = snapshot();
+    old_    = older_;
+    stop_   = false;
+    thread_ = std::thread(&Metrics::serverLoop, this);
+
+    logInfo("Metrics on http://0.0.0.0:%d/metrics", port);
+    return true;
+}
+
+void Metrics::stop()
+{
+    if (thread_.joinable())
+    {
+        stop_ = true;
+        const uint64_t one = 1;
+        (void)!write(wakeFd_, &one, sizeof(one));
+        thread_.join();
+    }
+
+    if (listenFd_ >= 0) ::close(listenFd_);
+    if (wakeFd_   >= 0) ::close(wakeFd_);
+    listenFd_ = -1;
+    wakeFd_   = -1;
+}
+
+void Metrics::serverLoop()
+{
+    traceThread("metrics");
+    while (!stop_)
+    {
+        pollfd fds[2] = { { listenFd_, POLLIN, 0 }, { wakeFd_, POLLIN, 0 } };
+        if (poll(fds, 2, 1000) < 0 && errno != EINTR)
+            break;
+
+        const double now = nowSeconds();
+        if (now - old_.at >= METRICS_WINDOW_S)
+        {
+            older_ = std::move(old_);
+            old_   = snapshot();
+        }
+
+        if (!(fds[0].revents & POLLIN)) continue;
+        const int fd = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+        serveClient(fd);
+        ::close(fd);
+    }
+}
+
+// One request per connection; scrapers are local and infrequent, so the
+// exchange is done blocking with short socket timeouts.
+void Metrics::serveClient(int fd)
+{
+    timeval tv{ 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    std::string req;
+    char buf[1024];
+    while (req.find("\r\n\r\n") == std::string::npos && req.size() < METRICS_MAX_REQUEST)
+    {
+        const ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) return;
+        req.append(buf, n);
+    }
+
+    std::string body, status = "200 OK";
+    if (req.compare(0, 13, "GET /metrics ") == 0 || req.compare(0, 6, "GET / ") == 0)
+        body = render();
+    else
+    {
+        status = "404 Not Found";
+        body   = "try /metrics\n";
+    }
+
+    std::string resp;
+    appendf(resp, "HTTP/1.1 %s\r\n"
+                  "Content-Type: text/plain; version=0.0.4\r\n"
+                  "Content-Length: %zu\r\n"
+                  "Connection: close\r\n\r\n", status.c_str(), body.size());
+    resp += body;
+
+    size_t off = 0;
+    while (off < resp.size())
+    {
+        const ssize_t n = ::send(fd, resp.data() + off, resp.size() - off, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        off += n;
+    }
+}
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================
+// METRICS
+//
+// Counters and histograms for dashboards, served as Prometheus text on
+// http://host:<port>/metrics (--metrics-port <port>).  Recording is a
+// few relaxed atomic increments and never allocates or locks; all
+// formatting, /proc reads and socket work happen on the server thread.
+//
+// Exported:
+//   vision_frames_{captured,processed,skipped}_total{camera}
+//   vision_{camera,processed}_fps{camera}, vision_published_fps
+//   vision_stage_seconds{stage,quantile}   p50/p90/p99 over the last 10-20 s
+//   vision_lock_{wait,hold}_seconds{lock,site,quantile}  same window
+//   vision_detections_per_frame{camera}    histogram
+//   vision_tag_confidence                  histogram (accepted sightings)
+//   vision_thread_cpu_seconds_total{thread,tid}  from /proc/self/task
+//   vision_tracking_alloc{s,_bytes}_total{camera}  ALLOC_TRACKING builds
+//   plus the counters registered with addCounter() (drops etc.)
+// ============================================================
+
+enum class Stage : uint8_t
+{
+    Copy,      // capture: map, clone and release of the camera buffer
+    Queue,     // frame handed over -> tracking thread picks it up
+    Capture,   // buffer timestamp -> detection starts (live cameras)
+    Detect,    // apriltag_detector_detect
+    Pose,      // solvePnP / confidence / gating for all detections
+    Fuse,      // multi-camera fusion under poseMutex
+    Frame,     // tracking thread, pickup -> snapshot posted
+    Publish,   // post() -> sent to every subscriber and sink
+    Count
+};
+
+const char* stageName(Stage s);
+
+// Every frameMutex / poseMutex acquisition, as lock/site label pairs
+enum class LockSite : uint8_t
+{
+    FramePublish,   // frame: capture / replay hands a frame over
+    FramePickup,    // frame: tracking thread takes it
+    FrameVis,       // frame: vis takes it for display
+    PoseGate,       // pose:  tracking copies the fused track for gating
+    PoseFuse,       // pose:  tracking merges its sightings
+    PoseVis,        // pose:  vis copies the track for the overlay
+    Count
+};
+
+// Nearest-rank quantile of raw samples (NaN when empty), for tools that
+// keep every sample; the tracker's own stages use the histograms below
+inline double sampleQuantile(std::vector<double> v, double q)
+{
+    if (v.empty()) return NAN;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, static_cast<size_t>(q * (v.size() - 1) + 0.5))];
+}
+
+// Log-linear buckets (8 per octave) from 1 us to ~2 s; quantiles are
+// interpolated inside a bucket, so they are good to roughly 5 %.
+struct LatencyHistogram
+{
+    static constexpr int SUB     = 8;             // buckets per octave
+    static constexpr int BUCKETS = 1 + 21 * SUB;  // [0, 1024 ns) + 2^10 .. 2^31 ns
+
+    std::atomic<uint64_t> counts[BUCKETS] = {};
+    std::atomic<uint64_t> sumNs{0};
+
+    void record(int64_t ns);
+
+    static int    bucketOf(int64_t ns);
+    static double bucketUpperNs(int i);
+};
+
+// A histogram's bucket counts at one moment, for windowed quantiles
+// read outside the server thread
+struct LatencyMark
+{
+    uint64_t counts[LatencyHistogram::BUCKETS] = {};
+};
+
+// Fixed-bound histogram for small values (detections, confidence)
+struct ValueHistogram
+{
+    std::vector<double>                      bounds;   // upper bounds, ascending
+    std::unique_ptr<std::atomic<uint64_t>[]> counts;   // bounds.size() + 1 (+Inf)
+    std::atomic<uint64_t>                    sumMilli{0};
+
+    void init(std::vector<double> upperBounds);
+    void record(double v);
+};
+
+struct CameraMetrics
+{
+    std::string           id;
+    std::atomic<uint64_t> captured{0};
+    std::atomic<uint64_t> processed{0};
+    std::atomic<uint64_t> skipped{0};     // frames replaced before tracking saw them
+    std::atomic<uint64_t> poseSolves{0};  // tracking-tag solvePnP runs
+    std::atomic<uint64_t> poseCacheHits{0}; // sightings reusing a cached pose (pose_core.hpp)
+    std::atomic<uint64_t> allocs{0};      // tracking thread operator new (ALLOC_TRACKING)
+    std::atomic<uint64_t> allocBytes{0};
+    ValueHistogram        detections;
+};
+
+class Metrics
+{
+public:
+    Metrics() = default;
+    ~Metrics();
+
+    Metrics(const Metrics&)            = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    // Call before any thread records.
+    void init(const std::vector<std::string>& cameraIds);
+
+    // Extra counters read at scrape time (e.g. publisher / logger drops);
+    // register before serve().
+    void addCounter(const std::string& name, const std::string& help,
+                    std::function<uint64_t()> read);
+
+    bool serve(int port);
+    void stop();
+
+    void stage(Stage s, int64_t ns) { latency_[static_cast<int>(s)].record(ns); }
+    void lockWait(LockSite l, int64_t ns) { latency_[LOCK_WAIT + static_cast<int>(l)].record(ns); }
+    void lockHold(LockSite l, int64_t ns) { latency_[LOCK_HOLD + static_cast<int>(l)].record(ns); }
+    CameraMetrics& camera(int index) { return *cameras_[index]; }
+    void published()               { published_.fetch_add(1, std::memory_order_relaxed); }
+    void confidence(double c)      { confidence_.record(c); }
+
+    // Quantile of a stage over the whole run, in seconds (NaN before the
+    // first sample); for tests and tools
+    double stageQuantile(Stage s, double q) const;
+
+    // Marks a stage's counts now, and the quantile of the samples
+    // recorded since a mark (NaN if none): windows such as the vis
+    // overlay's summary period
+    void   stageMark(Stage s, LatencyMark& out) const;
+    double stageQuantileSince(Stage s, const LatencyMark& mark, double q) const;
+
+    // Prometheus text exposition of everything above (server thread, or
+    // any thread once stop() has returned)
+    std::string render();
+
+private:
+    struct Counter
+    {
+        std::string               name;
+        std::string               help;
+        std::function<uint64_t()> read;
+    };
+
+    struct Window   // cumulative values at one instant
+    {
+        double                at = 0.0;
+        std::vector<uint64_t> latency;   // LATENCY_COUNT x BUCKETS
+        std::vector<uint64_t> captured, processed;
+        uint64_t              published = 0;
+    };
+
+    Window snapshot() const;
+    void   serverLoop();
+    void   serveClient(int fd);
+
+    // Stages, then lock waits, then lock holds
+    static constexpr int LOCK_WAIT     = static_cast<int>(Stage::Count);
+    static constexpr int LOCK_HOLD     = LOCK_WAIT + static_cast<int>(LockSite::Count);
+    static constexpr int LATENCY_COUNT = LOCK_HOLD + static_cast<int>(LockSite::Count);
+
+    void appendLatency(std::string& out, const char* name, const std::string& labels,
+                       int index, const Window& cur, const Window& base) const;
+
+    LatencyHistogram latency_[LATENCY_COUNT];
+    ValueHistogram   confidence_;
+    std::atomic<uint64_t> published_{0};
+
+    std::vector<std::unique_ptr<CameraMetrics>> cameras_;
+    std::vector<Counter> counters_;
+
+    // Rotated by the server thread; rates and quantiles use now - older_
+    Window older_, old_;
+
+    int               listenFd_ = -1;
+    int               wakeFd_   = -1;
+    std::atomic<bool> stop_{false};
+    std::thread       thread_;
+};
+
+extern Metrics metrics;
+
+// Records the enclosing scope's duration into a stage histogram.
+class StageTimer
+{
+public:
+    explicit StageTimer(Stage s) : stage_(s), begin_(std::chrono::steady_clock::now()) {}
+    ~StageTimer()
+    {
+        metrics.stage(stage_, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now() - begin_).count());
+    }
+
+    StageTimer(const StageTimer&)            = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    Stage                                 stage_;
+    std::chrono::steady_clock::time_point begin_;
+};
+
+// std::unique_lock stand-in that records, per call site, how long the
+// mutex took to acquire and how long it was held.
+class ProfiledLock
+{
+public:
+    ProfiledLock(std::mutex& m, LockSite site)
+        : site_(site), lock_(m, std::defer_lock)
+    {
+        const auto t0 = std::chrono::steady_clock::now();
+        lock_.lock();
+        acquired_ = std::chrono::steady_clock::now();
+        metrics.lockWait(site_, nanos(acquired_ - t0));
+    }
+
+    ~ProfiledLock()
+    {
+        if (lock_.owns_lock())
+            metrics.lockHold(site_, heldNs_ + nanos(std::chrono::steady_clock::now() - acquired_));
+    }
+
+    // condition_variable::wait_for.  The hold so far is kept and hold
+    // time resumes when it returns, so one sample covers both sides of
+    // the sleep.  Re-taking the mutex on wake-up happens inside wait_for
+    // and cannot be told apart from the sleep, so it is counted as
+    // neither wait nor hold.
+    template <class Rep, class Period, class Pred>
+    bool waitFor(std::condition_variable& cv,
+                 const std::chrono::duration<Rep, Period>& timeout, Pred pred)
+    {
+        heldNs_ += nanos(std::chrono::steady_clock::now() - acquired_);
+        const bool ok = cv.wait_for(lock_, timeout, pred);
+        acquired_ = std::chrono::steady_clock::now();
+        return ok;
+    }
+
+    ProfiledLock(const ProfiledLock&)            = delete;
+    ProfiledLock& operator=(const ProfiledLock&) = delete;
+
+private:
+    static int64_t nanos(std::chrono::steady_clock::duration d)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    }
+
+    LockSite                              site_;
+    std::unique_lock<std::mutex>          lock_;
+    std::chrono::steady_clock::time_point acquired_;
+    int64_t                               heldNs_ = 0;   // before waitFor() sleeps
+};
@@ -0,0 +1,282 @@
+#include "mjpeg_server.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "async_logger.hpp"
+#include "trace.hpp"
+
+constexpr size_t MJPEG_MAX_CLIENTS = 8;
+constexpr size_t MJPEG_MAX_REQUEST = 8192;
+constexpr char   MJPEG_BOUNDARY[]  = "frame";
+
+// ============================================================
+// MJPEG SERVER
+// ============================================================
+
+MjpegServer::~MjpegServer()
+{
+    stop();
+}
+
+bool MjpegServer::start(int port, const std::vector<std::string>& streams)
+{
+    stop();
+
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0)
+    {
+        logError("MJPEG server: socket() failed: %s", std::strerror(errno));
+        return false;
+    }
+
+    int one = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listenFd_, 4) < 0)
+    {
+        logError("MJPEG server: cannot listen on port %d: %s", port, std::strerror(errno));
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0)
+    {
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    streams_.clear();
+    for (const auto& name : streams)
+        streams_.push_back({ name, std::string(), 0 });
+    watched_ = 0;
+    stop_    = false;
+    thread_  = std::thread(&MjpegServer::serverLoop, this);
+
+    logInfo("MJPEG preview on http://0.0.0.0:%d/", port);
+    return true;
+}
+
+void MjpegServer::stop()
+{
+    if (thread_.joinable())
+    {
+        stop_ = true;
+        const uint64_t one = 1;
+        (void)!write(wakeFd_, &one, sizeof(one));
+        thread_.join();
+    }
+
+    for (auto& c : clients_)
+        ::close(c.fd);
+    clients_.clear();
+    watched_ = 0;
+
+    if (listenFd_ >= 0) ::close(listenFd_);
+    if (wakeFd_   >= 0) ::close(wakeFd_);
+    listenFd_ = -1;
+    wakeFd_   = -1;
+}
+
+void MjpegServer::publish(size_t stream, const std::vector<uint8_t>& jpeg)
+{
+    if (listenFd_ < 0 || stream >= streams_.size()) return;
+    {
+        std::lock_guard<std::mutex> lock(streamMutex_);
+        streams_[stream].jpeg.assign(jpeg.begin(), jpeg.end());
+        ++streams_[stream].seq;
+    }
+    const uint64_t one = 1;
+    (void)!write(wakeFd_, &one, sizeof(one));
+}
+
+void MjpegServer::acceptClients()
+{
+    for (;;)
+    {
+        const int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+
+        if (clients_.size() >= MJPEG_MAX_CLIENTS)
+        {
+            ::close(fd);
+            continue;
+        }
+
+        Client c;
+        c.fd = fd;
+        clients_.push_back(std::move(c));
+    }
+}
+
+// Reads the request line; answers with the stream header or a 404.
+// False when the client should be dropped.
+bool MjpegServer::readClient(Client& c)
+{
+    char buf[2048];
+    for (;;)
+    {
+        const ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+        if (n > 0)
+        {
+            if (c.stream == -1) c.in.append(buf, static_cast<size_t>(n));
+            if (c.in.size() > MJPEG_MAX_REQUEST) return false;
+            continue;
+        }
+        if (n == 0) return false;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        if (errno == EINTR) continue;
+        return false;
+    }
+    if (c.stream != -1 || c.in.find("\r\n\r\n") == std::string::npos) return true;
+
+    // "GET /<name> HTTP/1.1"
+    std::string path;
+    if (c.in.compare(0, 4, "GET ") == 0)
+        path = c.in.substr(4, c.in.find(' ', 4) - 4);
+    c.in.clear();
+
+    int stream = -1;
+    if (path == "/" || path == "/stream") stream = 0;
+    for (size_t s = 0; s < streams_.size() && stream < 0; ++s)
+        if (path == "/" + streams_[s].name) stream = static_cast<int>(s);
+
+    if (stream < 0 || streams_.empty())
+    {
+        c.out = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        c.stream = -2;   // closes once flushed
+        return true;
+    }
+
+    c.stream = stream;
+    c.out = std::string("HTTP/1.0 200 OK\r\n"
+                        "Cache-Control: no-cache\r\n"
+                        "Pragma: no-cache\r\n"
+                        "Connection: close\r\n"
+                        "Content-Type: multipart/x-mixed-replace; boundary=") + MJPEG_BOUNDARY + "\r\n\r\n";
+    return true;
+}
+
+bool MjpegServer::flushClient(Client& c)
+{
+    while (c.outOff < c.out.size())
+    {
+        const ssize_t n = send(c.fd, c.out.data() + c.outOff, c.out.size() - c.outOff,
+                               MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0)
+        {
+            c.outOff += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        return false;
+    }
+    c.out.clear();
+    c.outOff = 0;
+    return c.stream != -2;
+}
+
+void MjpegServer::updateWatched()
+{
+    uint32_t mask = 0;
+    for (const auto& c : clients_)
+        if (c.stream >= 0 && c.stream < 32) mask |= 1u << c.stream;
+    watched_.store(mask, std::memory_order_relaxed);
+}
+
+void MjpegServer::serverLoop()
+{
+    traceThread("mjpeg server");
+    std::vector<std::string> latest(streams_.size());
+    std::vector<uint64_t>    latestSeq(streams_.size(), 0);
+    std::vector<pollfd>      fds;
+
+    while (!stop_)
+    {
+        fds.clear();
+        fds.push_back({ listenFd_, POLLIN, 0 });
+        fds.push_back({ wakeFd_,   POLLIN, 0 });
+        for (const auto& c : clients_)
+        {
+            short ev = POLLIN;
+            if (c.outOff < c.out.size()) ev |= POLLOUT;
+            fds.push_back({ c.fd, ev, 0 });
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR)
+            break;
+
+        if (fds[1].revents & POLLIN)
+        {
+            uint64_t v;
+            (void)!read(wakeFd_, &v, sizeof(v));
+        }
+
+        std::vector<bool> alive(clients_.size(), true);
+        for (size_t i = 0; i + 2 < fds.size(); ++i)
+        {
+            const short re = fds[i + 2].revents;
+            if (re & (POLLERR | POLLHUP | POLLNVAL)) alive[i] = false;
+            else if ((re & POLLIN) && !readClient(clients_[i])) alive[i] = false;
+        }
+        if (fds[0].revents & POLLIN)
+            acceptClients();
+
+        {
+            std::lock_guard<std::mutex> lock(streamMutex_);
+            for (size_t s = 0; s < streams_.size(); ++s)
+            {
+                if (streams_[s].seq == latestSeq[s]) continue;
+                latest[s]    = streams_[s].jpeg;
+                latestSeq[s] = streams_[s].seq;
+            }
+        }
+
+        for (size_t i = 0; i < clients_.size(); ++i)
+        {
+            if (i < alive.size() && !alive[i]) continue;
+            Client& c = clients_[i];
+            if (c.stream >= 0 && c.out.empty() && c.sentSeq < latestSeq[c.stream])
+            {
+                const std::string& jpeg = latest[c.stream];
+                c.out  = std::string("--") + MJPEG_BOUNDARY + "\r\nContent-Type: image/jpeg\r\n"
+                         "Content-Length: " + std::to_string(jpeg.size()) + "\r\n\r\n";
+                c.out += jpeg;
+                c.out += "\r\n";
+                c.sentSeq = latestSeq[c.stream];
+            }
+            if (!flushClient(c) && i < alive.size()) alive[i] = false;
+        }
+
+        // Drop dead clients (newly accepted ones are past alive.size())
+        size_t keep = 0;
+        for (size_t i = 0; i < clients_.size(); ++i)
+        {
+            if (i < alive.size() && !alive[i])
+            {
+                ::close(clients_[i].fd);
+                continue;
+            }
+            if (keep != i) clients_[keep] = std::move(clients_[i]);
+            ++keep;
+        }
+        clients_.resize(keep);
+        updateWatched();
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================
+// MJPEG SERVER
+//
+// Serves JPEG frames as multipart/x-mixed-replace over plain HTTP, so a
+// browser shows them as live video: http://host:port/ is the first
+// stream, http://host:port/<name> any other.  publish() only swaps the
+// latest JPEG of a stream under a mutex and wakes the server thread;
+// all socket work happens there on non-blocking sockets.  A client that
+// is still receiving one frame skips straight to the newest after it.
+// ============================================================
+
+class MjpegServer
+{
+public:
+    MjpegServer() = default;
+    ~MjpegServer();
+
+    MjpegServer(const MjpegServer&)            = delete;
+    MjpegServer& operator=(const MjpegServer&) = delete;
+
+    // One stream per name (e.g. camera ids)
+    bool start(int port, const std::vector<std::string>& streams);
+    void stop();
+
+    bool running() const { return listenFd_ >= 0; }
+
+    // True while at least one client watches `stream`; producers skip
+    // encoding otherwise.  Any thread.
+    bool wanted(size_t stream) const
+    {
+        return stream < 32 && (watched_.load(std::memory_order_relaxed) >> stream) & 1u;
+    }
+
+    // Replace the stream's frame (latest wins).  Any thread.
+    void publish(size_t stream, const std::vector<uint8_t>& jpeg);
+
+private:
+    struct Client
+    {
+        int         fd      = -1;
+        int         stream  = -1;   // set once the request is parsed; -2 after a 404
+        std::string in;
+        std::string out;
+        size_t      outOff  = 0;
+        uint64_t    sentSeq = 0;
+    };
+
+    struct Stream
+    {
+        std::string name;
+        std::string jpeg;
+        uint64_t    seq = 0;
+    };
+
+    void serverLoop();
+    void acceptClients();
+    bool readClient(Client& c);
+    bool flushClient(Client& c);
+    void updateWatched();
+
+    int listenFd_ = -1;
+    int wakeFd_   = -1;
+
+    std::mutex          streamMutex_;
+    std::vector<Stream> streams_;   // jpeg / seq guarded by streamMutex_
+
+    std::vector<Client>   clients_;   // server thread only
+    std::atomic<uint32_t> watched_{0};   // bit per stream with a client
+    std::atomic<bool>     stop_{false};
+    std::thread           thread_;
+};
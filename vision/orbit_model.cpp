@@ -0,0 +1,99 @@
+#include "orbit_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Alpha-beta gains for angle / angular rate and the radius low-pass,
+// per update (one fused frame)
+constexpr double ORBIT_ALPHA          = 0.5;
+constexpr double ORBIT_BETA           = 0.15;
+constexpr double ORBIT_RADIUS_GAIN    = 0.2;
+
+// Gate growth, as a fraction of the arc predicted since the last update
+constexpr double ORBIT_GATE_GAIN      = 0.5;
+
+// Closer than this the angle about the satellite means nothing
+constexpr double ORBIT_MIN_RADIUS     = 0.02;
+
+// ============================================================
+// ORBIT MODEL
+// ============================================================
+
+// Into (-pi, pi]
+static double wrapAngle(double a)
+{
+    a = std::fmod(a + M_PI, 2.0 * M_PI);
+    if (a <= 0.0) a += 2.0 * M_PI;
+    return a - M_PI;
+}
+
+bool OrbitModel::locked(double stamp) const
+{
+    return updates_ > 0 && stamp - stamp_ <= ORBIT_TIMEOUT_S;
+}
+
+void OrbitModel::update(double stamp, const Pose& satellite, const Pose& endMass)
+{
+    const double dx = endMass.x - satellite.x;
+    const double dy = endMass.y - satellite.y;
+    const double r  = std::hypot(dx, dy);
+    if (r < ORBIT_MIN_RADIUS) return;
+    const double a  = std::atan2(dy, dx);
+
+    if (!locked(stamp))
+    {
+        // (Re)acquire at rest
+        updates_ = 0;
+        angle_   = a;
+        omega_   = 0.0;
+        radius_  = r;
+    }
+    else
+    {
+        const double dt = stamp - stamp_;
+        if (dt <= 0.0) return;
+
+        if (updates_ == 1)
+        {
+            // First rate straight from two fixes, filtered from here on
+            omega_  = wrapAngle(a - angle_) / dt;
+            angle_  = a;
+            radius_ = 0.5 * (radius_ + r);
+        }
+        else
+        {
+            const double predicted = angle_ + omega_ * dt;
+            const double residual  = wrapAngle(a - predicted);
+            angle_   = wrapAngle(predicted + ORBIT_ALPHA * residual);
+            omega_  += ORBIT_BETA * residual / dt;
+            radius_ += ORBIT_RADIUS_GAIN * (r - radius_);
+        }
+    }
+    ++updates_;
+    stamp_ = stamp;
+    satX_  = satellite.x;
+    satY_  = satellite.y;
+}
+
+bool OrbitModel::predict(double stamp, double baseGate, OrbitPrediction& out) const
+{
+    if (!locked(stamp) || updates_ < ORBIT_SETTLE_UPDATES) return false;
+
+    const double dt = std::max(0.0, stamp - stamp_);
+    const double a  = angle_ + omega_ * dt;
+    out.x    = satX_ + radius_ * std::cos(a);
+    out.y    = satY_ + radius_ * std::sin(a);
+    out.gate = baseGate + ORBIT_GATE_GAIN * std::fabs(omega_) * radius_ * dt;
+    return true;
+}
+
+bool OrbitModel::accepts(double stamp, double baseGate, const Pose& endMass) const
+{
+    OrbitPrediction p;
+    if (predict(stamp, baseGate, p))
+        return std::hypot(endMass.x - p.x, endMass.y - p.y) <= p.gate;
+
+    // Rate not settled: anywhere at the tether length
+    const double r = std::hypot(endMass.x - satX_, endMass.y - satY_);
+    return std::fabs(r - radius_) <= baseGate;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "tag_registry.hpp"
+
+// ============================================================
+// ORBIT MODEL
+//
+// The end mass circles the satellite at a nearly constant tether length,
+// so where it will be next follows from three numbers taken about the
+// satellite: angle, angular rate and radius.  update() feeds one fused
+// satellite / end-mass pair; an alpha-beta filter tracks angle and rate,
+// a low-pass the radius.  predict() carries the angle forward to a later
+// stamp and places the end mass around the last satellite position.
+//
+// Its gate widens with the arc the end mass should have swept since the
+// last update, so the faster it spins the more room a rate error gets;
+// at rest it is the fixed jump gate.  Until the rate has settled after
+// (re)acquisition there is no prediction, and accepts() only asks for
+// the tether length, so lock can be taken on an end mass that is
+// already spinning fast.  Plain data: tracking threads copy it together
+// with the fused track under poseMutex.
+// ============================================================
+
+// Lock is dropped after this long without an update; predictions start
+// once this many updates have set the rate
+constexpr double ORBIT_TIMEOUT_S      = 0.5;
+constexpr int    ORBIT_SETTLE_UPDATES = 5;
+
+struct OrbitPrediction
+{
+    double x    = 0.0;   // end mass, world metres
+    double y    = 0.0;
+    double gate = 0.0;   // metres around (x, y)
+};
+
+class OrbitModel
+{
+public:
+    void reset() { *this = OrbitModel(); }
+
+    // Fused poses at `stamp` (steady clock seconds); stamps not newer
+    // than the last update are ignored.
+    void update(double stamp, const Pose& satellite, const Pose& endMass);
+
+    // False without a settled lock at `stamp`.  `baseGate` is the gate
+    // at zero angular rate.
+    bool predict(double stamp, double baseGate, OrbitPrediction& out) const;
+
+    // Gate for an end-mass sighting; only meaningful while locked()
+    bool accepts(double stamp, double baseGate, const Pose& endMass) const;
+
+    // Updated within ORBIT_TIMEOUT_S of `stamp`
+    bool   locked(double stamp) const;
+    double omega() const  { return omega_; }    // rad/s, counter-clockwise positive
+    double radius() const { return radius_; }   // metres
+
+private:
+    int    updates_ = 0;     // since (re)acquisition
+    double stamp_   = 0.0;
+    double satX_    = 0.0;
+    double satY_    = 0.0;
+    double angle_   = 0.0;   // rad, end mass about the satellite
+    double omega_   = 0.0;
+    double radius_  = 0.0;
+};
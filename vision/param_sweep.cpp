@@ -0,0 +1,400 @@
+// ============================================================
+// param_sweep — accuracy versus speed over detector settings
+//
+// Runs the tracker's detection + pose stage (tag_detector, PoseCore's
+// runtime variant) over a sequence for every combination of the
+// settings below, and prints frames/s, p99 per-frame latency, detection
+// rate and pose error for each, marking the Pareto-optimal rows.
+//
+//   param_sweep                                   synthetic orbit, default grid
+//   param_sweep --replay run01.frames --divider 2,4 --decimate 1,2,3
+//   param_sweep --synthetic 300 --threads 1,2,4 --csv sweep.csv
+//
+// Options:
+//   --replay <file>      recorded grey frames (--record); pose error is
+//                        measured against a reference pass at the
+//                        recording's resolution, decimate 1, refine on
+//   --synthetic <n>      frames of synthetic_scene.hpp with ground truth (90)
+//   --divider <list>     resolution_divider values          (2,4)
+//   --decimate <list>    quad_decimate values               (1,2,3)
+//   --refine <list>      refine_edges values                (0,1)
+//   --threads <list>     detector nthreads values           (4)
+//   --min-conf <list>    min_track_conf values              (0.3,0.45,0.6)
+//   --tags <list>        tracked tag ids                    (0,1)
+//   --tag-size <m>       tracking tag edge                  (0.056)
+//   --warmup <n>         frames left out of the timings     (5)
+//   --csv <file>         also write the table as CSV
+//
+// Lists are comma separated.  Frames are kept in memory per divider, so
+// divider 1 (12 MB per frame) wants a short sequence.
+// ============================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include <apriltag/apriltag.h>
+
+#include "camera.hpp"
+#include "frame_file.hpp"
+#include "metrics.hpp"
+#include "pose_core.hpp"
+#include "synthetic_scene.hpp"
+#include "tag_detector.hpp"
+#include "tag_registry.hpp"
+
+// Intrinsics for --replay
+constexpr const CameraSpec& SWEEP_CAMERA = CAMERA_SPECS[0];
+
+struct Sighting
+{
+    int       frame;
+    int       tag;      // index into the tracked tag list
+    double    conf;
+    cv::Vec3d tvec;
+};
+
+struct DetectionRun   // one detector configuration over the sequence
+{
+    int    divider  = 1;
+    double decimate = 1.0;
+    int    refine   = 1;
+    int    threads  = 1;
+    std::vector<double>   latencyMs = {};   // per measured frame
+    std::vector<Sighting> sightings = {};
+};
+
+struct Row
+{
+    int    divider    = 1;
+    double decimate   = 1.0;
+    int    refine     = 1;
+    int    threads    = 1;
+    double minConf    = 0.0;
+    double fps        = 0.0;
+    double p99Ms      = 0.0;
+    double detectRate = 0.0;   // accepted / expected sightings
+    double errMm      = 0.0;   // mean position error of accepted sightings
+    double errP95Mm   = 0.0;
+    bool   pareto     = false;
+};
+
+static double nowMs()
+{
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::vector<double> parseList(const char* s)
+{
+    std::vector<double> out;
+    for (const char* p = s; *p; )
+    {
+        char* end;
+        const double v = std::strtod(p, &end);
+        if (end == p) break;
+        out.push_back(v);
+        p = *end == ',' ? end + 1 : end;
+    }
+    return out;
+}
+
+// ============================================================
+// SEQUENCE
+// ============================================================
+
+struct Sequence
+{
+    std::vector<cv::Mat> frames;
+    cv::Mat K, D;
+};
+
+// Synthetic frames rendered directly at SENSOR / divider
+static void syntheticSequence(int divider, int count, double tagSize, Sequence& seq)
+{
+    CameraContext cam;
+    initCamera(cam, 0, SWEEP_CAMERA, divider);
+
+    SceneSettings s;
+    s.width   = SENSOR_W / divider;
+    s.height  = SENSOR_H / divider;
+    s.fx      = cam.K.at<double>(0, 0);
+    s.fy      = cam.K.at<double>(1, 1);
+    s.cx      = cam.K.at<double>(0, 2);
+    s.cy      = cam.K.at<double>(1, 2);
+    s.tagSize = tagSize;
+
+    SyntheticScene scene(s);
+    seq.frames.resize(count);
+    for (int i = 0; i < count; ++i) scene.render(i, seq.frames[i]);
+    seq.K = scene.K();
+    seq.D = cv::Mat::zeros(1, 5, CV_64F);   // the scene has no lens distortion
+}
+
+// Recorded frames scaled from the recording's divider to `divider`
+static bool replaySequence(const FrameFileReader& reader, int divider, Sequence& seq)
+{
+    const int recDivider = static_cast<int>(SENSOR_W / reader.header().width);
+    if (divider < recDivider) return false;
+
+    CameraContext cam;
+    initCamera(cam, 0, SWEEP_CAMERA, divider);
+    seq.K = cam.K;
+    seq.D = cam.D;
+
+    const cv::Size size(SENSOR_W / divider, SENSOR_H / divider);
+    seq.frames.resize(reader.size());
+    for (size_t i = 0; i < reader.size(); ++i)
+    {
+        cv::Mat img = reader.image(i);
+        if (img.channels() != 1) cv::cvtColor(img, img, cv::COLOR_BGR2GRAY);
+        if (divider == recDivider) seq.frames[i] = img.clone();
+        else                       cv::resize(img, seq.frames[i], size, 0, 0, cv::INTER_AREA);
+    }
+    return true;
+}
+
+// ============================================================
+// DETECTION PASS
+// ============================================================
+
+static void runDetection(const Sequence& seq, const TagRegistry& tags, double tagSize,
+                         int warmup, DetectionRun& run)
+{
+    DetectorSettings settings;
+    settings.quadDecimate = run.decimate;
+    settings.refineEdges  = run.refine != 0;
+    settings.nthreads     = run.threads;
+    apriltag_detector_t* td = createDetector(settings);
+
+    const PoseCore<DynamicRig> core(DynamicRig(seq.K, seq.D, tagSize, &tags));
+    TagSighting sighting;
+    for (size_t f = 0; f < seq.frames.size(); ++f)
+    {
+        const cv::Mat& gray = seq.frames[f];
+        image_u8_t img = { gray.cols, gray.rows, static_cast<int32_t>(gray.step[0]), gray.data };
+
+        const double t0 = nowMs();
+        zarray_t* detections = apriltag_detector_detect(td, &img);
+        for (int i = 0; i < zarray_size(detections); ++i)
+        {
+            apriltag_detection_t* det;
+            zarray_get(detections, i, &det);
+            if (det->hamming > 1) continue;
+
+            const int slot = core.trackSlot(det->id);
+            if (slot < 0) continue;
+
+            core.solve(det, sighting);
+            run.sightings.push_back({ static_cast<int>(f), slot, sighting.confidence, sighting.tvec });
+        }
+        apriltag_detections_destroy(detections);
+        const double t1 = nowMs();
+
+        if (static_cast<int>(f) >= warmup) run.latencyMs.push_back(t1 - t0);
+    }
+
+    destroyDetector(td);
+}
+
+// ============================================================
+// SCORING
+// ============================================================
+
+// Truth per (frame, tag); NaN z = not expected in that frame
+using Truth = std::vector<std::vector<cv::Vec3d>>;
+
+static Row score(const DetectionRun& run, double minConf, const Truth& truth)
+{
+    Row row{ run.divider, run.decimate, run.refine, run.threads, minConf };
+
+    double totalMs = 0.0;
+    for (double ms : run.latencyMs) totalMs += ms;
+    row.fps   = totalMs > 0.0 ? run.latencyMs.size() * 1000.0 / totalMs : 0.0;
+    row.p99Ms = sampleQuantile(run.latencyMs, 0.99);
+
+    size_t expected = 0;
+    for (const auto& frame : truth)
+        for (const auto& t : frame)
+            if (!std::isnan(t[2])) ++expected;
+
+    // At most one accepted sighting per (frame, tag): the most confident
+    std::map<std::pair<int, int>, const Sighting*> best;
+    for (const auto& s : run.sightings)
+    {
+        if (s.conf < minConf) continue;
+        auto& b = best[{ s.frame, s.tag }];
+        if (!b || s.conf > b->conf) b = &s;
+    }
+
+    std::vector<double> err;
+    size_t hits = 0;
+    for (const auto& kv : best)
+    {
+        const cv::Vec3d& t = truth[kv.first.first][kv.first.second];
+        if (std::isnan(t[2])) continue;
+        ++hits;
+        err.push_back(cv::norm(kv.second->tvec - t) * 1000.0);
+    }
+
+    row.detectRate = expected ? double(hits) / expected : 0.0;
+    double sum = 0.0;
+    for (double e : err) sum += e;
+    row.errMm    = err.empty() ? NAN : sum / err.size();
+    row.errP95Mm = sampleQuantile(err, 0.95);
+    return row;
+}
+
+// a dominates b: no worse everywhere, better somewhere
+static bool dominates(const Row& a, const Row& b)
+{
+    const double aErr = std::isnan(a.errMm) ? 1e9 : a.errMm;
+    const double bErr = std::isnan(b.errMm) ? 1e9 : b.errMm;
+    const bool noWorse = a.fps >= b.fps && a.p99Ms <= b.p99Ms &&
+                         a.detectRate >= b.detectRate && aErr <= bErr;
+    const bool better  = a.fps > b.fps || a.p99Ms < b.p99Ms ||
+                         a.detectRate > b.detectRate || aErr < bErr;
+    return noWorse && better;
+}
+
+// ============================================================
+// MAIN
+// ============================================================
+
+int main(int argc, char** argv)
+{
+    std::string replayPath, csvPath;
+    int synthetic = 90, warmup = 5;
+    double tagSize = 0.056;
+    std::vector<double> dividers = { 2, 4 }, decimates = { 1, 2, 3 }, refines = { 0, 1 },
+                        threads = { 4 }, minConfs = { 0.3, 0.45, 0.6 }, tagList = { 0, 1 };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if      (arg == "--replay"    && i + 1 < argc) replayPath = argv[++i];
+        else if (arg == "--synthetic" && i + 1 < argc) synthetic  = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--divider"   && i + 1 < argc) dividers   = parseList(argv[++i]);
+        else if (arg == "--decimate"  && i + 1 < argc) decimates  = parseList(argv[++i]);
+        else if (arg == "--refine"    && i + 1 < argc) refines    = parseList(argv[++i]);
+        else if (arg == "--threads"   && i + 1 < argc) threads    = parseList(argv[++i]);
+        else if (arg == "--min-conf"  && i + 1 < argc) minConfs   = parseList(argv[++i]);
+        else if (arg == "--tags"      && i + 1 < argc) tagList    = parseList(argv[++i]);
+        else if (arg == "--tag-size"  && i + 1 < argc) tagSize    = std::atof(argv[++i]);
+        else if (arg == "--warmup"    && i + 1 < argc) warmup     = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--csv"       && i + 1 < argc) csvPath    = argv[++i];
+        else
+        {
+            std::fprintf(stderr, "unknown option %s (see param_sweep.cpp)\n", arg.c_str());
+            return 2;
+        }
+    }
+    if (dividers.empty() || decimates.empty() || refines.empty() || threads.empty() ||
+        minConfs.empty() || tagList.empty())
+        return 2;
+
+    TagRegistry tags;
+    for (double t : tagList)
+        tags.addTracking(static_cast<int>(t), "tag" + std::to_string(static_cast<int>(t)), 0.0);
+    const std::vector<int>& tagIds = tags.trackIds;
+    if (tagIds.empty()) return 2;
+
+    FrameFileReader reader;
+    if (!replayPath.empty() && !reader.open(replayPath)) return 1;
+
+    // --- Ground truth: the scene, or a reference pass over the recording ---
+    Truth truth;
+    if (replayPath.empty())
+    {
+        SceneSettings s;
+        s.tagSize = tagSize;
+        SyntheticScene scene(s);
+        truth.resize(synthetic, std::vector<cv::Vec3d>(tagIds.size(), cv::Vec3d(0, 0, NAN)));
+        for (int f = 0; f < synthetic; ++f)
+            for (const auto& t : scene.truth(f))
+            {
+                const int slot = tags.trackSlot(t.id);
+                if (slot >= 0) truth[f][slot] = t.tvec;
+            }
+    }
+    else
+    {
+        const int recDivider = static_cast<int>(SENSOR_W / reader.header().width);
+        Sequence seq;
+        replaySequence(reader, recDivider, seq);
+
+        DetectionRun ref{ recDivider, 1.0, 1, 4 };
+        runDetection(seq, tags, tagSize, 0, ref);
+        truth.resize(seq.frames.size(), std::vector<cv::Vec3d>(tagIds.size(), cv::Vec3d(0, 0, NAN)));
+        for (const auto& s : ref.sightings)
+            if (s.conf >= 0.45) truth[s.frame][s.tag] = s.tvec;
+        std::fprintf(stderr, "reference pass: %zu frames at divider %d\n",
+                     seq.frames.size(), recDivider);
+    }
+
+    // --- Sweep ---
+    std::vector<Row> rows;
+    for (double d : dividers)
+    {
+        const int divider = std::max(1, static_cast<int>(d));
+        Sequence seq;
+        if (replayPath.empty())
+            syntheticSequence(divider, synthetic, tagSize, seq);
+        else if (!replaySequence(reader, divider, seq))
+        {
+            std::fprintf(stderr, "divider %d is finer than the recording; skipped\n", divider);
+            continue;
+        }
+
+        for (double dec : decimates)
+            for (double ref : refines)
+                for (double th : threads)
+                {
+                    DetectionRun run{ divider, dec, static_cast<int>(ref), std::max(1, static_cast<int>(th)) };
+                    runDetection(seq, tags, tagSize, warmup, run);
+                    for (double mc : minConfs)
+                        rows.push_back(score(run, mc, truth));
+                    std::fprintf(stderr, "divider %d decimate %.1f refine %d threads %d done\n",
+                                 run.divider, run.decimate, run.refine, run.threads);
+                }
+    }
+
+    for (auto& r : rows)
+        r.pareto = std::none_of(rows.begin(), rows.end(),
+                                [&](const Row& o) { return dominates(o, r); });
+
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.fps > b.fps; });
+
+    std::printf("%-3s %7s %8s %6s %7s %8s %9s %8s %9s %10s\n",
+                "", "divider", "decimate", "refine", "threads", "min_conf",
+                "fps", "p99_ms", "detect_%", "err_mm");
+    for (const auto& r : rows)
+        std::printf("%-3s %7d %8.1f %6d %7d %8.2f %9.1f %8.2f %9.1f %5.2f/%4.2f\n",
+                    r.pareto ? "*" : "", r.divider, r.decimate, r.refine, r.threads, r.minConf,
+                    r.fps, r.p99Ms, r.detectRate * 100.0, r.errMm, r.errP95Mm);
+    std::printf("\n* Pareto-optimal (fps, p99, detection rate, error); err_mm = mean/p95\n");
+
+    if (!csvPath.empty())
+    {
+        FILE* f = std::fopen(csvPath.c_str(), "w");
+        if (!f)
+        {
+            std::fprintf(stderr, "cannot write %s\n", csvPath.c_str());
+            return 1;
+        }
+        std::fprintf(f, "divider,decimate,refine,threads,min_conf,fps,p99_ms,detect_rate,err_mm,err_p95_mm,pareto\n");
+        for (const auto& r : rows)
+            std::fprintf(f, "%d,%.2f,%d,%d,%.3f,%.2f,%.3f,%.4f,%.3f,%.3f,%d\n",
+                         r.divider, r.decimate, r.refine, r.threads, r.minConf,
+                         r.fps, r.p99Ms, r.detectRate, r.errMm, r.errP95Mm, r.pareto ? 1 : 0);
+        std::fclose(f);
+    }
+    return 0;
+}
@@ -0,0 +1,272 @@
+// ============================================================
+// perf_budget — performance budget test for the tracking thread
+//
+// Registered with CTest (see CMakeLists.txt):
+//
+//   perf_budget generate <file> [--frames N] [--bgr]
+//       Renders the synthetic orbit (synthetic_scene.hpp) with calibration
+//       tags 2-5, at the tracker's capture size and with cam0's intrinsics
+//       and distortion, into a frame file.  Deterministic.  --bgr stores
+//       3-channel frames, as live cameras deliver them, so a replay runs
+//       the tracker's greyscale conversion.
+//
+//   perf_budget run <file> [--min-fps X] [--max-p99-ms Y] [--max-err-mm Z]
+//                   [--alloc-strict] [--recalibrate-at N]
+//       Replays the file through the real tracker (startTracker, no vis)
+//       and checks the given budgets:
+//         --min-fps     tracked frames per second over the whole replay
+//         --max-p99-ms  p99 of the tracking thread's per-frame time
+//                       (vision_stage_seconds{stage="frame"})
+//         --max-err-mm  p95 world position error of the tracked tags;
+//                       also fails if a tag is seen in < 90 % of frames
+//       --alloc-strict runs the tracker with it (ALLOC_TRACKING builds):
+//       an allocation on the tracking thread after warm-up aborts the
+//       run.  --recalibrate-at sends `recalibrate` once N frames are
+//       tracked.
+//
+// Exit status: 0 within budget, 1 budget missed, 2 usage / setup error.
+// The tracker can start once per process, so each check is its own run.
+// ============================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include <gst/gst.h>
+
+#include "async_logger.hpp"
+#include "frame_file.hpp"
+#include "frame_recorder.hpp"
+#include "metrics.hpp"
+#include "synthetic_scene.hpp"
+#include "tracker.hpp"
+
+constexpr int    DEFAULT_FRAMES   = 90;
+constexpr double SEQUENCE_FPS     = 30.0;
+constexpr double SEQUENCE_EPOCH   = 1.7e9;   // unix time of frame 0
+constexpr double MIN_SEEN_RATIO   = 0.90;    // per tag, frames after calibration
+
+static SceneSettings sceneFor(const TrackerSetup& setup)
+{
+    const int divider = SENSOR_W / setup.width;
+
+    SceneSettings s;
+    s.width       = setup.width;
+    s.height      = setup.height;
+    s.fx          = setup.camera.fx / divider;
+    s.fy          = setup.camera.fy / divider;
+    s.cx          = setup.camera.cx / divider;
+    s.cy          = setup.camera.cy / divider;
+    std::copy(setup.camera.dist, setup.camera.dist + 5, s.dist);
+    s.tagSize     = setup.tagSize;
+    s.calibSquare = setup.calibSquare;
+    s.fps         = SEQUENCE_FPS;
+    return s;
+}
+
+// ============================================================
+// GENERATE
+// ============================================================
+
+static int generate(const std::string& path, int frames, bool bgr)
+{
+    const TrackerSetup setup = trackerSetup();
+    SyntheticScene scene(sceneFor(setup));
+
+    FrameRecorder recorder;
+    if (!recorder.open(path, setup.width, setup.height, bgr ? 3 : 1)) return 2;
+
+    for (int i = 0; i < frames; ++i)
+    {
+        cv::Mat gray, image;   // the recorder holds on to `image` until written
+        scene.render(i, gray);
+        if (bgr) cv::cvtColor(gray, image, cv::COLOR_GRAY2BGR);
+        else     image = gray;
+
+        FrameRecordHeader meta{};
+        meta.frameId  = static_cast<uint64_t>(i + 1);
+        meta.seq      = static_cast<uint64_t>(i + 1);
+        meta.stamp    = i / SEQUENCE_FPS;
+        meta.unixTime = SEQUENCE_EPOCH + i / SEQUENCE_FPS;
+        meta.camera   = 0;
+
+        // The recorder drops rather than blocks; here every frame matters
+        while (!recorder.push(meta, image))
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    recorder.close();
+
+    std::printf("%s: %d frames, %dx%d%s\n", path.c_str(), frames, setup.width, setup.height,
+                bgr ? " BGR" : "");
+    return recorder.written() == static_cast<uint64_t>(frames) ? 0 : 2;
+}
+
+// ============================================================
+// RUN
+// ============================================================
+
+static int run(const std::string& path, double minFps, double maxP99Ms, double maxErrMm,
+               bool allocStrict, uint64_t recalibrateAt)
+{
+    size_t frames;
+    {
+        FrameFileReader reader;
+        if (!reader.open(path)) return 2;
+        frames = reader.size();
+    }
+
+    TrackerOptions opts;
+    opts.replayPath  = path;
+    opts.visualise   = false;
+    opts.historyRows = frames;
+    opts.allocStrict = allocStrict;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    if (!startTracker(opts))
+    {
+        stopTracker();
+        return 2;
+    }
+    if (recalibrateAt > 0)
+    {
+        while (trackerRunning() && metrics.camera(0).processed.load() < recalibrateAt)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::printf("frame %llu: %s\n", static_cast<unsigned long long>(recalibrateAt),
+                    trackerCommand({ "recalibrate" }).c_str());
+    }
+    waitTracker();
+    const double elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - t0).count();
+    stopTracker();
+
+    const uint64_t processed = metrics.camera(0).processed.load();
+    const double   fps       = processed / elapsed;
+    const double   p99Ms     = metrics.stageQuantile(Stage::Frame, 0.99) * 1e3;
+
+    // World position error per visible tag, against the scene's truth
+    SyntheticScene scene(sceneFor(trackerSetup()));
+    const PoseHistory&      h   = *poseHistory;
+    const std::vector<int>& ids = trackedTagIds();
+    const size_t rows = std::min<size_t>(h.written(), h.rows());
+
+    std::vector<double>   err;
+    std::vector<uint32_t> seen(ids.size(), 0);
+    for (size_t r = 0; r < rows; ++r)
+    {
+        const int index = static_cast<int>(std::lround((h.stamp[r] - SEQUENCE_EPOCH) * SEQUENCE_FPS));
+        for (const SceneTag& tag : scene.truth(index))
+        {
+            const auto it = std::find(ids.begin(), ids.end(), tag.id);
+            if (it == ids.end()) continue;
+            const size_t k = r * h.tags() + static_cast<size_t>(it - ids.begin());
+            if (!h.visible[k]) continue;
+
+            const cv::Point2d w = SyntheticScene::worldPosition(tag);
+            err.push_back(std::hypot(h.x[k] - w.x, h.y[k] - w.y) * 1000.0);
+            ++seen[it - ids.begin()];
+        }
+    }
+
+    // The first frame calibrates; tracking starts with the second
+    const double expected = frames > 1 ? static_cast<double>(frames - 1) : 1.0;
+    double minSeen = 1.0;
+    for (uint32_t n : seen) minSeen = std::min(minSeen, n / expected);
+
+    double errMean = 0.0;
+    for (double e : err) errMean += e;
+    errMean = err.empty() ? NAN : errMean / err.size();
+    const double errP95 = sampleQuantile(err, 0.95);
+
+    std::printf("frames %llu/%zu  %.1f fps  p99 %.2f ms  err %.2f/%.2f mm (mean/p95)  seen %.1f %%\n",
+                static_cast<unsigned long long>(processed), frames, fps, p99Ms,
+                errMean, errP95, minSeen * 100.0);
+
+    bool ok = processed == frames;
+    if (!ok)
+        std::printf("FAIL: %llu of %zu frames tracked\n",
+                    static_cast<unsigned long long>(processed), frames);
+    if (minFps > 0.0 && !(fps >= minFps))
+    {
+        std::printf("FAIL: throughput %.1f fps below budget %.1f fps\n", fps, minFps);
+        ok = false;
+    }
+    if (maxP99Ms > 0.0 && !(p99Ms <= maxP99Ms))
+    {
+        std::printf("FAIL: p99 frame time %.2f ms above budget %.2f ms\n", p99Ms, maxP99Ms);
+        ok = false;
+    }
+    if (maxErrMm > 0.0)
+    {
+        if (!(errP95 <= maxErrMm))
+        {
+            std::printf("FAIL: p95 pose error %.2f mm above tolerance %.2f mm\n", errP95, maxErrMm);
+            ok = false;
+        }
+        if (minSeen < MIN_SEEN_RATIO)
+        {
+            std::printf("FAIL: a tracked tag was seen in %.1f %% of frames (< %.0f %%)\n",
+                        minSeen * 100.0, MIN_SEEN_RATIO * 100.0);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+// ============================================================
+// MAIN
+// ============================================================
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "usage: perf_budget generate|run <file> [options] (see perf_budget.cpp)\n");
+        return 2;
+    }
+    const std::string mode = argv[1], path = argv[2];
+
+    int      frames        = DEFAULT_FRAMES;
+    double   minFps        = 0.0, maxP99Ms = 0.0, maxErrMm = 0.0;
+    bool     allocStrict   = false;
+    bool     bgr           = false;
+    uint64_t recalibrateAt = 0;
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if      (arg == "--frames"     && i + 1 < argc) frames   = std::max(2, std::atoi(argv[++i]));
+        else if (arg == "--min-fps"    && i + 1 < argc) minFps   = std::atof(argv[++i]);
+        else if (arg == "--max-p99-ms" && i + 1 < argc) maxP99Ms = std::atof(argv[++i]);
+        else if (arg == "--max-err-mm" && i + 1 < argc) maxErrMm = std::atof(argv[++i]);
+        else if (arg == "--bgr")                         bgr = true;
+        else if (arg == "--alloc-strict")                allocStrict = true;
+        else if (arg == "--recalibrate-at" && i + 1 < argc)
+            recalibrateAt = std::strtoull(argv[++i], nullptr, 10);
+        else
+        {
+            std::fprintf(stderr, "unknown option %s (see perf_budget.cpp)\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    if (mode != "generate" && mode != "run")
+    {
+        std::fprintf(stderr, "unknown mode %s\n", mode.c_str());
+        return 2;
+    }
+
+    gst_init(&argc, &argv);
+    logger.start();
+    const int status = mode == "generate" ? generate(path, frames, bgr)
+                                          : run(path, minFps, maxP99Ms, maxErrMm,
+                                                allocStrict, recalibrateAt);
+    logger.stop();
+    return status;
+}
@@ -0,0 +1,109 @@
+#include "perf_counters.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "async_logger.hpp"
+
+static const uint64_t PERF_CONFIGS[PERF_EVENTS] =
+{
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+static const char* const PERF_NAMES[PERF_EVENTS] =
+{
+    "cycles", "instructions", "cache-misses", "branch-misses"
+};
+
+static int perfEventOpen(uint64_t config, int groupFd)
+{
+    perf_event_attr attr{};
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = config;
+    attr.disabled       = groupFd < 0;   // leader starts disabled, enabled below
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+
+// ============================================================
+// PERF COUNTERS
+// ============================================================
+
+PerfCounters::~PerfCounters()
+{
+    close();
+}
+
+bool PerfCounters::open()
+{
+    close();
+
+    fds_[PerfCycles] = perfEventOpen(PERF_CONFIGS[PerfCycles], -1);
+    if (fds_[PerfCycles] < 0)
+    {
+        logWarn("perf_event_open(cycles) failed: %s (no PMU, or kernel.perf_event_paranoid > 2)",
+                std::strerror(errno));
+        return false;
+    }
+    slot_[PerfCycles] = 0;
+    opened_ = 1;
+
+    for (int e = PerfCycles + 1; e < PERF_EVENTS; ++e)
+    {
+        fds_[e] = perfEventOpen(PERF_CONFIGS[e], fds_[PerfCycles]);
+        if (fds_[e] < 0)
+        {
+            logWarn("perf_event_open(%s) failed: %s; reported as 0",
+                    PERF_NAMES[e], std::strerror(errno));
+            slot_[e] = -1;
+            continue;
+        }
+        slot_[e] = opened_++;
+    }
+
+    ioctl(fds_[PerfCycles], PERF_EVENT_IOC_RESET,  PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[PerfCycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void PerfCounters::close()
+{
+    for (int& fd : fds_)
+    {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+    opened_ = 0;
+}
+
+void PerfCounters::read(PerfSample& out) const
+{
+    if (!isOpen()) return;
+
+    // PERF_FORMAT_GROUP: { nr, value[nr] } in the order the events were added
+    uint64_t buf[1 + PERF_EVENTS];
+    if (::read(fds_[PerfCycles], buf, sizeof(buf)) < static_cast<ssize_t>(sizeof(uint64_t)))
+        return;
+
+    for (int e = 0; e < PERF_EVENTS; ++e)
+        out.v[e] = slot_[e] >= 0 && static_cast<uint64_t>(slot_[e]) < buf[0] ? buf[1 + slot_[e]] : 0;
+}
+
+void PerfCounters::addSince(const PerfSample& begin, PerfSample& total) const
+{
+    if (!isOpen()) return;
+    PerfSample now;
+    read(now);
+    total.add(begin, now);
+}
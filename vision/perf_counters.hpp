@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+
+// ============================================================
+// HARDWARE PERFORMANCE COUNTERS  (--perf-counters)
+//
+// One perf_event_open group per tracking thread: cycles, instructions,
+// cache misses and branch misses, user space only, counting just the
+// calling thread.  The group is read (one read() syscall) at the start
+// and end of a stage and the difference added to that stage's totals;
+// the per-camera summary turns those into IPC and misses per thousand
+// instructions.
+//
+// Threads the calling thread hands work to are not counted, so
+// --perf-counters runs AprilTag with detector_threads = 1; otherwise
+// its workers would do the detection unseen.
+//
+// Needs kernel.perf_event_paranoid <= 2 (the Raspberry Pi OS default).
+// If the group cannot be opened the tracker runs without it.
+// ============================================================
+
+enum PerfEvent { PerfCycles, PerfInstructions, PerfCacheMisses, PerfBranchMisses, PERF_EVENTS };
+
+struct PerfSample
+{
+    uint64_t v[PERF_EVENTS] = {};
+
+    void add(const PerfSample& begin, const PerfSample& end)
+    {
+        for (int i = 0; i < PERF_EVENTS; ++i) v[i] += end.v[i] - begin.v[i];
+    }
+};
+
+class PerfCounters
+{
+public:
+    PerfCounters() = default;
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&)            = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Counts the calling thread from now on.
+    bool open();
+    void close();
+    bool isOpen() const { return fds_[0] >= 0; }
+
+    // Current counts; events the PMU lacks read as 0.  No-ops when closed.
+    void read(PerfSample& out) const;
+
+    // total += now - begin
+    void addSince(const PerfSample& begin, PerfSample& total) const;
+
+private:
+    int fds_[PERF_EVENTS]  = { -1, -1, -1, -1 };
+    int slot_[PERF_EVENTS] = {};   // position in the group read, -1 = not counted
+    int opened_            = 0;
+};
+
+// Adds the enclosing scope's counts to `total` (no-op when closed).
+class PerfScope
+{
+public:
+    PerfScope(const PerfCounters& pc, PerfSample& total) : pc_(pc), total_(total)
+    {
+        pc_.read(begin_);
+    }
+
+    ~PerfScope()
+    {
+        pc_.addSince(begin_, total_);
+    }
+
+    PerfScope(const PerfScope&)            = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    const PerfCounters& pc_;
+    PerfSample&         total_;
+    PerfSample          begin_;
+};
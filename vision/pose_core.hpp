@@ -0,0 +1,251 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include <apriltag/apriltag.h>
+
+#include "tag_detector.hpp"
+#include "tag_registry.hpp"
+
+// ============================================================
+// POSE CORE
+//
+// The tracking thread's per-sighting math -- detected corners ->
+// solvePnP -> confidence -> world position and yaw -- templated on a
+// rig description:
+//
+//   DynamicRig       intrinsics, tag size and tag slots read at startup;
+//                    any config / --profile, used for experiments.
+//   FixedRig<R>      the same from R's constexpr members: the
+//                    distortion and projection arithmetic is folded
+//                    against constant intrinsics, and slot lookup and
+//                    per-tag loops have compile-time trip counts.
+//
+// Both use fixed-size buffers (Matx / Vec / std::array) throughout, so
+// a sighting never touches the heap.  solvePnP itself is OpenCV's and
+// is the same call in both.
+// ============================================================
+
+struct TagSighting
+{
+    Pose         pose;          // world x, y and yaw (degrees)
+    double       confidence = 0.0;
+    cv::Vec3d    tvec;          // camera frame, metres
+    TagCorners2f corners;
+};
+
+// Intrinsics and tag set known only at runtime
+class DynamicRig
+{
+public:
+    DynamicRig(const cv::Mat& K, const cv::Mat& D, double tagSize, const TagRegistry* tags)
+        : fx_(K.at<double>(0, 0)), fy_(K.at<double>(1, 1)),
+          cx_(K.at<double>(0, 2)), cy_(K.at<double>(1, 2)),
+          k1_(D.at<double>(0)), k2_(D.at<double>(1)), p1_(D.at<double>(2)),
+          p2_(D.at<double>(3)), k3_(D.at<double>(4)),
+          tagSize_(tagSize), tags_(tags) {}
+
+    double fx() const { return fx_; }
+    double fy() const { return fy_; }
+    double cx() const { return cx_; }
+    double cy() const { return cy_; }
+    double k1() const { return k1_; }
+    double k2() const { return k2_; }
+    double p1() const { return p1_; }
+    double p2() const { return p2_; }
+    double k3() const { return k3_; }
+    double tagSize() const { return tagSize_; }
+
+    int    tagCount() const    { return static_cast<int>(tags_->trackCount()); }
+    int    trackSlot(int id) const { return tags_->trackSlot(id); }
+
+private:
+    double fx_, fy_, cx_, cy_;
+    double k1_, k2_, p1_, p2_, k3_;
+    double tagSize_;
+    const TagRegistry* tags_;
+};
+
+// Everything constexpr, from a rig description such as ProductionRig
+template <class R>
+struct FixedRig
+{
+    static constexpr int TAGS = static_cast<int>(R::TAG_IDS.size());
+
+    constexpr double fx() const { return R::FX; }
+    constexpr double fy() const { return R::FY; }
+    constexpr double cx() const { return R::CX; }
+    constexpr double cy() const { return R::CY; }
+    constexpr double k1() const { return R::K1; }
+    constexpr double k2() const { return R::K2; }
+    constexpr double p1() const { return R::P1; }
+    constexpr double p2() const { return R::P2; }
+    constexpr double k3() const { return R::K3; }
+    constexpr double tagSize() const { return R::TAG_SIZE; }
+
+    constexpr int tagCount() const { return TAGS; }
+    constexpr int trackSlot(int id) const
+    {
+        for (int s = 0; s < TAGS; ++s)
+            if (R::TAG_IDS[s] == id) return s;
+        return -1;
+    }
+};
+
+template <class Rig>
+class PoseCore
+{
+public:
+    explicit PoseCore(const Rig& rig = Rig())
+        : rig_(rig), obj_(tagObjectPoints(rig.tagSize())) {}
+
+    const Rig& rig() const { return rig_; }
+    int tagCount() const       { return rig_.tagCount(); }
+    int trackSlot(int id) const { return rig_.trackSlot(id); }
+
+    // Camera -> world as calibrate() stores it (p_world = R * p_cam + t)
+    void setCalibration(const cv::Mat& R, const cv::Mat& t)
+    {
+        R_ = cv::Matx33d(R);
+        t_ = cv::Vec3d(t);
+    }
+
+    // Pose and confidence of one detection; the caller applies thresholds.
+    void solve(const apriltag_detection_t* det, TagSighting& out) const
+    {
+        for (int k = 0; k < 4; ++k)
+            out.corners[k] = cv::Point2f(static_cast<float>(det->p[k][0]),
+                                         static_cast<float>(det->p[k][1]));
+
+        const cv::Matx33d K(rig_.fx(), 0.0, rig_.cx(),
+                            0.0, rig_.fy(), rig_.cy(),
+                            0.0, 0.0, 1.0);
+        const cv::Vec<double, 5> D(rig_.k1(), rig_.k2(), rig_.p1(), rig_.p2(), rig_.k3());
+
+        cv::Vec3d rvec;
+        cv::solvePnP(obj_, out.corners, K, D, rvec, out.tvec);
+
+        cv::Matx33d R;
+        cv::Rodrigues(rvec, R);
+
+        // Mean reprojection error of the four corners
+        double reproj = 0.0;
+        for (int k = 0; k < 4; ++k)
+        {
+            const cv::Vec3d p = R * cv::Vec3d(obj_[k].x, obj_[k].y, obj_[k].z) + out.tvec;
+            const cv::Point2d q = project(p);
+            reproj += std::hypot(out.corners[k].x - q.x, out.corners[k].y - q.y);
+        }
+        reproj /= 4.0;
+
+        const double diag = std::hypot(det->p[2][0] - det->p[0][0], det->p[2][1] - det->p[0][1]);
+        out.confidence = confidenceScore(det->decision_margin, det->hamming, reproj, diag);
+
+        const cv::Vec3d w = R_ * out.tvec + t_;
+        out.pose.x   = w[0];
+        out.pose.y   = w[1];
+        // Yaw of the tag in the world frame, so every camera reports the same
+        const cv::Matx33d Rw = R_ * R;
+        out.pose.yaw = std::atan2(Rw(1, 0), Rw(0, 0)) * 180.0 / CV_PI;
+    }
+
+    // Image point of a world point (after setCalibration)
+    cv::Point2d projectWorld(const cv::Vec3d& w) const
+    {
+        return project(R_.t() * (w - t_));
+    }
+
+private:
+    // Pinhole + k1 k2 p1 p2 k3 (OpenCV's model, as cv::projectPoints)
+    cv::Point2d project(const cv::Vec3d& p) const
+    {
+        const double x  = p[0] / p[2], y = p[1] / p[2];
+        const double r2 = x * x + y * y;
+        const double radial = 1.0 + r2 * (rig_.k1() + r2 * (rig_.k2() + r2 * rig_.k3()));
+        const double xd = x * radial + 2.0 * rig_.p1() * x * y + rig_.p2() * (r2 + 2.0 * x * x);
+        const double yd = y * radial + rig_.p1() * (r2 + 2.0 * y * y) + 2.0 * rig_.p2() * x * y;
+        return { rig_.fx() * xd + rig_.cx(), rig_.fy() * yd + rig_.cy() };
+    }
+
+    Rig                        rig_;
+    std::array<cv::Point3f, 4> obj_;
+    cv::Matx33d                R_ = cv::Matx33d::eye();
+    cv::Vec3d                  t_;
+};
+
+// ============================================================
+// SIGHTING CACHE
+//
+// Last solved sighting per track slot.  A tag whose four corners are all
+// within `maxMovePx` of where they were at its last solve gets that
+// solve's pose and confidence back instead of a new solvePnP; the
+// corners are compared with the solve's, not the last frame's, so slow
+// drift still triggers a re-solve once it adds up.  Owned by one
+// tracking thread; clear() whenever the calibration changes.
+// ============================================================
+
+class SightingCache
+{
+public:
+    void resize(size_t slots) { entries_.assign(slots, Entry{}); }
+    void clear()
+    {
+        for (auto& e : entries_) e.valid = false;
+    }
+
+    // True and `out` filled (with this detection's corners) on a hit
+    bool reuse(int slot, const apriltag_detection_t* det, double maxMovePx, TagSighting& out)
+    {
+        if (maxMovePx <= 0.0 || slot < 0 || slot >= static_cast<int>(entries_.size())) return false;
+        const Entry& e = entries_[slot];
+        if (!e.valid || e.hamming != det->hamming) return false;
+
+        const double max2 = maxMovePx * maxMovePx;
+        for (int k = 0; k < 4; ++k)
+        {
+            const double dx = det->p[k][0] - e.sighting.corners[k].x;
+            const double dy = det->p[k][1] - e.sighting.corners[k].y;
+            if (dx * dx + dy * dy > max2) return false;
+        }
+
+        out.pose       = e.sighting.pose;
+        out.confidence = e.sighting.confidence;
+        out.tvec       = e.sighting.tvec;
+        for (int k = 0; k < 4; ++k)
+            out.corners[k] = cv::Point2f(static_cast<float>(det->p[k][0]),
+                                         static_cast<float>(det->p[k][1]));
+        ++hits_;
+        return true;
+    }
+
+    // After a solve of `slot`
+    void store(int slot, const apriltag_detection_t* det, const TagSighting& solved)
+    {
+        ++solves_;
+        if (slot < 0 || slot >= static_cast<int>(entries_.size())) return;
+        Entry& e   = entries_[slot];
+        e.sighting = solved;
+        e.hamming  = det->hamming;
+        e.valid    = true;
+    }
+
+    uint64_t hits() const   { return hits_; }
+    uint64_t solves() const { return solves_; }
+
+private:
+    struct Entry
+    {
+        TagSighting sighting;
+        int         hamming = 0;
+        bool        valid   = false;
+    };
+
+    std::vector<Entry> entries_;
+    uint64_t           hits_   = 0;
+    uint64_t           solves_ = 0;
+};
@@ -0,0 +1,75 @@
+#include "pose_history.hpp"
+
+#include <chrono>
+
+// ============================================================
+// POSE HISTORY
+// ============================================================
+
+PoseHistory::PoseHistory(size_t rows, size_t tags)
+    : rowSeq(new std::atomic<uint64_t>[rows == 0 ? 1 : rows]),
+      rows_(rows == 0 ? 1 : rows),
+      tags_(tags)
+{
+    for (size_t r = 0; r < rows_; ++r) rowSeq[r].store(0, std::memory_order_relaxed);
+    frameId.assign(rows_, 0);
+    stamp.assign(rows_, 0.0);
+    camera.assign(rows_, 0);
+    x.assign(rows_ * tags_, 0.0);
+    y.assign(rows_ * tags_, 0.0);
+    yaw.assign(rows_ * tags_, 0.0);
+    conf.assign(rows_ * tags_, 0.0);
+    visible.assign(rows_ * tags_, 0);
+}
+
+void PoseHistory::append(const PoseSnapshot& snap)
+{
+    const uint64_t n   = written_.load(std::memory_order_relaxed) + 1;
+    const size_t   row = static_cast<size_t>((n - 1) % rows_);
+
+    rowSeq[row].store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    frameId[row] = snap.frameId;
+    stamp[row]   = snap.unixTime;
+    camera[row]  = snap.camera;
+
+    const TrackSet& ts = snap.tracks;
+    const size_t base  = row * tags_;
+    for (size_t k = 0; k < tags_ && k < ts.size(); ++k)
+    {
+        x[base + k]       = ts.pose[k].x;
+        y[base + k]       = ts.pose[k].y;
+        yaw[base + k]     = ts.pose[k].yaw;
+        conf[base + k]    = ts.confidence[k];
+        visible[base + k] = ts.visible[k];
+    }
+
+    rowSeq[row].store(n, std::memory_order_release);
+    written_.store(n, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    cv_.notify_all();
+}
+
+uint64_t PoseHistory::waitFor(uint64_t after, double timeoutS)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    const uint64_t gen = wakeGen_;
+    cv_.wait_for(lock, std::chrono::duration<double>(timeoutS), [&]
+    {
+        return written() > after || wakeGen_ != gen;
+    });
+    return written();
+}
+
+void PoseHistory::wake()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++wakeGen_;
+    }
+    cv_.notify_all();
+}
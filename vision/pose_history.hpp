@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "publisher.hpp"
+
+// ============================================================
+// POSE HISTORY
+//
+// Fixed-size ring of the last N published frames, one array per field,
+// for in-process consumers (the Python module exposes the arrays to
+// NumPy without copying).  Per-tag fields are [row][tag] row-major.
+//
+// Written by a single thread (the publisher).  Frame n (counting from 1)
+// lands in row (n - 1) % rows.  rowSeq[row] is 0 while the row is being
+// written and n once complete, so a reader that sees the same rowSeq
+// before and after copying a row knows the copy is consistent.
+// ============================================================
+
+class PoseHistory
+{
+public:
+    PoseHistory(size_t rows, size_t tags);
+
+    PoseHistory(const PoseHistory&)            = delete;
+    PoseHistory& operator=(const PoseHistory&) = delete;
+
+    void append(const PoseSnapshot& snap);
+
+    // Frames appended so far.
+    uint64_t written() const { return written_.load(std::memory_order_acquire); }
+
+    // Block until written() > after, the timeout expires or wake() is
+    // called.  Returns written().
+    uint64_t waitFor(uint64_t after, double timeoutS);
+    void     wake();
+
+    size_t rows() const { return rows_; }
+    size_t tags() const { return tags_; }
+
+    // Column storage
+    std::unique_ptr<std::atomic<uint64_t>[]> rowSeq;
+    std::vector<uint64_t> frameId;
+    std::vector<double>   stamp;     // capture time, unix seconds
+    std::vector<int32_t>  camera;
+    std::vector<double>   x, y, yaw, conf;   // [rows * tags]
+    std::vector<uint8_t>  visible;           // [rows * tags]
+
+private:
+    size_t rows_;
+    size_t tags_;
+
+    std::atomic<uint64_t>   written_{0};
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+    uint64_t                wakeGen_ = 0;
+};
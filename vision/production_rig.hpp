@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+
+#include "camera.hpp"
+
+// ============================================================
+// PRODUCTION RIG
+//
+// The configuration the fixed tracking variant is compiled for
+// (cmake -DTRACKER_FIXED_RIG=ON, the default): cam0's intrinsics at
+// resolution_divider 2, 56 mm tags, satellite 0 and end mass 1.  A
+// tracking thread uses the fixed variant only when its camera spec and
+// the runtime config match these values exactly, and logs which one it
+// picked.  Intrinsics are read from CAMERA_SPECS[0]; keep the divider
+// and tag size in step with the config.hpp defaults.
+// ============================================================
+
+#ifdef TRACKER_FIXED_RIG
+constexpr bool FIXED_RIG = true;
+#else
+constexpr bool FIXED_RIG = false;
+#endif
+
+struct ProductionRig
+{
+    static constexpr int DIVIDER = 2;
+    static constexpr int WIDTH   = SENSOR_W / DIVIDER;
+    static constexpr int HEIGHT  = SENSOR_H / DIVIDER;
+
+    // cam0 (CAMERA_SPECS[0]), full resolution
+    static constexpr const CameraSpec& SPEC = CAMERA_SPECS[0];
+
+    static constexpr double FX_FULL = SPEC.fx;
+    static constexpr double FY_FULL = SPEC.fy;
+    static constexpr double CX_FULL = SPEC.cx;
+    static constexpr double CY_FULL = SPEC.cy;
+
+    static constexpr double FX = FX_FULL / DIVIDER;
+    static constexpr double FY = FY_FULL / DIVIDER;
+    static constexpr double CX = CX_FULL / DIVIDER;
+    static constexpr double CY = CY_FULL / DIVIDER;
+
+    static constexpr double K1 = SPEC.dist[0], K2 = SPEC.dist[1], P1 = SPEC.dist[2],
+                            P2 = SPEC.dist[3], K3 = SPEC.dist[4];
+
+    static constexpr double TAG_SIZE = 0.056;
+
+    // Track slot order: satellite, then end masses (registerTags)
+    static constexpr std::array<int, 2> TAG_IDS = { 0, 1 };
+};
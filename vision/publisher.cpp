@@ -0,0 +1,328 @@
+#include "publisher.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "async_logger.hpp"
+#include "trace.hpp"
+
+constexpr uint32_t BINARY_MAGIC = 0x314B5254;   // "TRK1" little-endian
+
+static double nowSeconds()
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+static void appendRaw(std::string& out, const T& v)
+{
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+// Value of "key=" in a "?a=1&b=2" query string, empty if absent.
+static std::string queryValue(const std::string& query, const char* key)
+{
+    const std::string k = std::string(key) + "=";
+    size_t pos = 0;
+    while (pos < query.size())
+    {
+        size_t end = query.find('&', pos);
+        if (end == std::string::npos) end = query.size();
+        if (query.compare(pos, k.size(), k) == 0)
+            return query.substr(pos + k.size(), end - pos - k.size());
+        pos = end + 1;
+    }
+    return {};
+}
+
+// ============================================================
+// PUBLISHER
+// ============================================================
+
+Publisher::~Publisher()
+{
+    stop();
+    for (auto& s : subs_)
+        if (s.fd >= 0) ::close(s.fd);
+}
+
+bool Publisher::addSubscriber(const std::string& spec)
+{
+    Subscriber sub;
+    sub.spec = spec;
+
+    std::string target = spec, query;
+    const size_t q = spec.find('?');
+    if (q != std::string::npos)
+    {
+        target = spec.substr(0, q);
+        query  = spec.substr(q + 1);
+    }
+
+    const std::string format = queryValue(query, "format");
+    if (format == "binary")
+        sub.format = PublishFormat::Binary;
+    else if (!format.empty() && format != "contract")
+    {
+        logError("Subscriber %s: unknown format '%s'", spec.c_str(), format.c_str());
+        return false;
+    }
+
+    const double hz = std::atof(queryValue(query, "hz").c_str());
+    sub.interval = hz > 0.0 ? 1.0 / hz : 0.0;
+
+    if (target.compare(0, 6, "udp://") == 0)
+    {
+        const std::string hostPort = target.substr(6);
+        const size_t colon = hostPort.rfind(':');
+        auto* in = reinterpret_cast<sockaddr_in*>(&sub.addr);
+        in->sin_family = AF_INET;
+        if (colon == std::string::npos ||
+            inet_pton(AF_INET, hostPort.substr(0, colon).c_str(), &in->sin_addr) != 1)
+        {
+            logError("Subscriber %s: expected udp://<ipv4>:<port>", spec.c_str());
+            return false;
+        }
+        in->sin_port = htons(static_cast<uint16_t>(std::atoi(hostPort.c_str() + colon + 1)));
+        sub.addrLen  = sizeof(sockaddr_in);
+
+        sub.fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (sub.fd >= 0 && IN_MULTICAST(ntohl(in->sin_addr.s_addr)))
+        {
+            const std::string ttlArg = queryValue(query, "ttl");
+            const unsigned char ttl = static_cast<unsigned char>(ttlArg.empty() ? 1 : std::atoi(ttlArg.c_str()));
+            setsockopt(sub.fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+        }
+    }
+    else if (target.compare(0, 7, "unix://") == 0)
+    {
+        const std::string path = target.substr(7);
+        auto* un = reinterpret_cast<sockaddr_un*>(&sub.addr);
+        if (path.empty() || path.size() >= sizeof(un->sun_path))
+        {
+            logError("Subscriber %s: bad socket path", spec.c_str());
+            return false;
+        }
+        un->sun_family = AF_UNIX;
+        std::memcpy(un->sun_path, path.c_str(), path.size() + 1);
+        sub.addrLen = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() + 1);
+
+        sub.fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    }
+    else
+    {
+        logError("Subscriber %s: expected udp:// or unix://", spec.c_str());
+        return false;
+    }
+
+    if (sub.fd < 0)
+    {
+        logError("Subscriber %s: socket() failed: %s", spec.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    subs_.push_back(sub);
+    return true;
+}
+
+void Publisher::addLocalSink(std::function<void(const PoseSnapshot&)> sink)
+{
+    localSinks_.push_back(std::move(sink));
+}
+
+bool Publisher::start(const std::vector<int>& tagIds, int satelliteSlot, int endMassSlot,
+                      const std::vector<std::string>& cameraIds, size_t queueDepth)
+{
+    stop();
+
+    tagIds_        = tagIds;
+    satelliteSlot_ = satelliteSlot;
+    endMassSlot_   = endMassSlot;
+    cameraIds_     = cameraIds;
+
+    ring_.assign(std::max<size_t>(queueDepth, 1), PoseSnapshot());
+    for (auto& s : ring_) s.tracks.resize(tagIds.size());
+    current_.tracks.resize(tagIds.size());
+    head_  = 0;
+    count_ = 0;
+
+    contract_.reserve(256 + 128 * tagIds.size());
+    binary_.reserve(24 + 20 * tagIds.size());
+
+    dropped_ = 0;
+    stop_    = false;
+    thread_  = std::thread(&Publisher::publisherLoop, this);
+
+    for (const auto& s : subs_)
+        logInfo("Publishing %s", s.spec.c_str());
+    return true;
+}
+
+void Publisher::stop()
+{
+    if (!thread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+
+    for (const auto& s : subs_)
+        logInfo("Subscriber %s: %llu sent, %llu failed", s.spec.c_str(),
+                static_cast<unsigned long long>(s.sent),
+                static_cast<unsigned long long>(s.failed));
+    if (dropped_)
+        logWarn("Publisher dropped %llu snapshots (queue full)",
+                static_cast<unsigned long long>(dropped_.load()));
+}
+
+bool Publisher::post(uint64_t frameId, double unixTime, int camera, const TrackSet& tracks)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_ || count_ == ring_.size())   // also before start(): ring empty
+        {
+            ++dropped_;
+            return false;
+        }
+        PoseSnapshot& s = ring_[(head_ + count_) % ring_.size()];
+        s.frameId  = frameId;
+        s.unixTime = unixTime;
+        s.camera   = camera;
+        s.postedAt = nowSeconds();
+        s.tracks   = tracks;   // equal sizes: copies into existing storage
+        ++count_;
+    }
+    wake_.notify_one();
+    return true;
+}
+
+void Publisher::publisherLoop()
+{
+    traceThread("publisher");
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stop_ || count_ > 0; });
+            if (count_ == 0) return;   // stopping and drained
+
+            // Swap storage with the ring slot; both keep their sizes.
+            std::swap(current_, ring_[head_]);
+            head_ = (head_ + 1) % ring_.size();
+            --count_;
+        }
+
+        publish(current_);
+        for (auto& sink : localSinks_) sink(current_);
+    }
+}
+
+void Publisher::publish(const PoseSnapshot& snap)
+{
+    const double now = nowSeconds();
+    const double cap = minInterval_.load(std::memory_order_relaxed);
+    bool haveContract = false, haveBinary = false, contractOk = false;
+
+    for (auto& s : subs_)
+    {
+        const double interval = std::max(s.interval, cap);
+        if (interval > 0.0 && now < s.nextSend) continue;
+
+        const std::string* payload = nullptr;
+        if (s.format == PublishFormat::Contract)
+        {
+            if (!haveContract) { contractOk = formatContract(snap); haveContract = true; }
+            if (!contractOk) continue;
+            payload = &contract_;
+        }
+        else
+        {
+            if (!haveBinary) { formatBinary(snap); haveBinary = true; }
+            payload = &binary_;
+        }
+
+        TraceScope t("sendto", 0, snap.frameId);
+        const ssize_t n = sendto(s.fd, payload->data(), payload->size(), MSG_DONTWAIT,
+                                 reinterpret_cast<const sockaddr*>(&s.addr), s.addrLen);
+        if (n < 0) ++s.failed;
+        else       ++s.sent;
+
+        if (interval > 0.0)
+            s.nextSend = (now - s.nextSend < interval) ? s.nextSend + interval
+                                                       : now + interval;
+    }
+}
+
+// Detector contract (docs/api.md section 1).  Only sent while the
+// satellite and primary end mass are both visible, as the bridge requires.
+bool Publisher::formatContract(const PoseSnapshot& snap)
+{
+    const TrackSet& ts = snap.tracks;
+    if (!ts.visible[satelliteSlot_] || !ts.visible[endMassSlot_]) return false;
+
+    const Pose& satellite = ts.pose[satelliteSlot_];
+    const Pose& endMass   = ts.pose[endMassSlot_];
+
+    // orbital angle from satellite -> end-mass vector (radians)
+    const double orbital = std::atan2(endMass.y - satellite.y, endMass.x - satellite.x);
+    const double conf    = std::min(ts.confidence[satelliteSlot_],
+                                    ts.confidence[endMassSlot_]);
+
+    const std::string& camera = cameraIds_[snap.camera];
+    contract_.clear();
+    appendf(contract_,
+            "{\"timestamp\":%.6f,\"frame_id\":%llu,\"camera_id\":\"%s\""
+            ",\"satellite_position\":{\"x\":%.4f,\"y\":%.4f}"
+            ",\"end_mass_position\":{\"x\":%.4f,\"y\":%.4f}"
+            ",\"orbital_angular_position\":%.6f,\"tracking_confidence\":%.3f,\"tags\":[",
+            snap.unixTime, static_cast<unsigned long long>(snap.frameId), camera.c_str(),
+            satellite.x, satellite.y, endMass.x, endMass.y, orbital, conf);
+
+    // Every tracked tag, so consumers can follow additional end masses.
+    for (size_t i = 0; i < ts.size(); ++i)
+        appendf(contract_,
+                "%s{\"id\":%d,\"x\":%.4f,\"y\":%.4f,\"yaw\":%.4f,\"conf\":%.3f,\"visible\":%s}",
+                i ? "," : "", tagIds_[i], ts.pose[i].x, ts.pose[i].y, ts.pose[i].yaw,
+                ts.confidence[i], ts.visible[i] ? "true" : "false");
+    contract_ += "]}";
+    return true;
+}
+
+// Packed little-endian record (docs/api.md section 4), sent every frame.
+void Publisher::formatBinary(const PoseSnapshot& snap)
+{
+    const TrackSet& ts = snap.tracks;
+
+    binary_.clear();
+    appendRaw(binary_, BINARY_MAGIC);
+    appendRaw(binary_, static_cast<uint16_t>(snap.camera));
+    appendRaw(binary_, static_cast<uint16_t>(ts.size()));
+    appendRaw(binary_, static_cast<uint64_t>(snap.frameId));
+    appendRaw(binary_, snap.unixTime);
+    for (size_t i = 0; i < ts.size(); ++i)
+    {
+        appendRaw(binary_, static_cast<uint16_t>(tagIds_[i]));
+        appendRaw(binary_, static_cast<uint8_t>(ts.visible[i] ? 1 : 0));
+        appendRaw(binary_, static_cast<uint8_t>(0));
+        appendRaw(binary_, static_cast<float>(ts.pose[i].x));
+        appendRaw(binary_, static_cast<float>(ts.pose[i].y));
+        appendRaw(binary_, static_cast<float>(ts.pose[i].yaw));
+        appendRaw(binary_, static_cast<float>(ts.confidence[i]));
+    }
+}
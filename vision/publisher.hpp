@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+
+#include "tag_registry.hpp"
+
+// ============================================================
+// PUBLISHER
+//
+// Fans tracker output out to a table of subscribers from one thread.
+// trackingThread only copies its TrackSet into a pre-sized snapshot
+// ring (post() never allocates, formats or touches a socket); the
+// publisher thread formats each snapshot once per format in use and
+// sends it to every subscriber that is due, on non-blocking sockets.
+//
+// Subscriber specs (repeat --publish for more than one):
+//   udp://127.0.0.1:9001                       full rate detector contract
+//   udp://239.1.2.3:9005?hz=5&ttl=2            multicast, 5 Hz
+//   udp://10.0.0.7:9002?format=binary&hz=10    packed binary (docs/api.md)
+//   unix:///tmp/tracker.sock?format=binary     Unix datagram socket
+// ============================================================
+
+enum class PublishFormat : uint8_t { Contract, Binary };
+
+struct PoseSnapshot
+{
+    uint64_t frameId  = 0;
+    double   unixTime = 0.0;   // capture time
+    int      camera   = 0;     // CameraContext::index
+    double   postedAt = 0.0;   // steady clock, when post() queued it
+    TrackSet tracks;
+};
+
+class Publisher
+{
+public:
+    Publisher() = default;
+    ~Publisher();
+
+    Publisher(const Publisher&)            = delete;
+    Publisher& operator=(const Publisher&) = delete;
+
+    // Parse and open one subscriber; call before start().
+    bool addSubscriber(const std::string& spec);
+
+    // Tag slots / ids come from the registry, camera ids index by camera.
+    bool start(const std::vector<int>& tagIds, int satelliteSlot, int endMassSlot,
+               const std::vector<std::string>& cameraIds, size_t queueDepth = 64);
+    void stop();   // sends what is queued, logs per-subscriber counts
+
+    // Runs on the publisher thread for every snapshot (e.g. the GUI
+    // stream, the pose history); call before start().
+    void addLocalSink(std::function<void(const PoseSnapshot&)> sink);
+
+    // Non-blocking.  Returns false if the snapshot ring was full.
+    bool post(uint64_t frameId, double unixTime, int camera, const TrackSet& tracks);
+
+    // Caps every subscriber at `hz` on top of its own ?hz=; 0 = no cap.
+    // Any thread, takes effect with the next snapshot.
+    void setRateLimit(double hz) { minInterval_ = hz > 0.0 ? 1.0 / hz : 0.0; }
+    double rateLimit() const
+    {
+        const double i = minInterval_.load();
+        return i > 0.0 ? 1.0 / i : 0.0;
+    }
+
+    size_t   subscriberCount() const { return subs_.size(); }
+    uint64_t dropped() const { return dropped_; }
+
+private:
+    struct Subscriber
+    {
+        std::string      spec;
+        int              fd      = -1;
+        sockaddr_storage addr{};
+        socklen_t        addrLen = 0;
+        PublishFormat    format  = PublishFormat::Contract;
+        double           interval = 0.0;   // 0 = every snapshot
+        double           nextSend = 0.0;
+        uint64_t         sent     = 0;
+        uint64_t         failed   = 0;     // EAGAIN / send errors
+    };
+
+    void publisherLoop();
+    void publish(const PoseSnapshot& snap);
+    bool formatContract(const PoseSnapshot& snap);
+    void formatBinary(const PoseSnapshot& snap);
+
+    std::vector<Subscriber> subs_;
+    std::vector<int>        tagIds_;
+    std::vector<std::string> cameraIds_;
+    int                     satelliteSlot_ = 0;
+    int                     endMassSlot_   = 0;
+
+    std::vector<std::function<void(const PoseSnapshot&)>> localSinks_;
+
+    // Snapshot ring, pre-sized so post() only copies
+    std::vector<PoseSnapshot> ring_;
+    size_t                    head_  = 0;
+    size_t                    count_ = 0;
+    PoseSnapshot              current_;   // publisher thread only
+
+    std::string contract_;   // per-snapshot format buffers, capacity reused
+    std::string binary_;
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    bool                    stop_ = false;
+    std::thread             thread_;
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<double>   minInterval_{0.0};
+};
@@ -0,0 +1,136 @@
+#include "synthetic_scene.hpp"
+
+#include <cmath>
+
+#include <apriltag/apriltag.h>
+#include <apriltag/tag36h11.h>
+
+// tag36h11 images from apriltag_to_image() are 10 x 10 px: a one pixel
+// white quiet zone around the 8 px black border.
+constexpr int TAG_IMAGE_PX  = 10;
+constexpr int TAG_BORDER_PX = 1;
+
+constexpr int SCENE_BACKGROUND = 128;
+
+// ============================================================
+// SYNTHETIC SCENE
+// ============================================================
+
+// Tag facing the camera, turned by `yaw` about the optical axis.  The tag
+// frame has y up the tag image and z towards the camera (tagObjectPoints).
+static cv::Vec3d facingCamera(double yaw)
+{
+    const double c = std::cos(yaw), s = std::sin(yaw);
+    const cv::Matx33d R(c,  s,  0,
+                        s, -c,  0,
+                        0,  0, -1);
+    cv::Vec3d rvec;
+    cv::Rodrigues(R, rvec);
+    return rvec;
+}
+
+SyntheticScene::SyntheticScene(const SceneSettings& settings)
+    : s_(settings)
+{
+    D_ = (cv::Mat1d(1, 5) <<
+        s_.dist[0], s_.dist[1], s_.dist[2], s_.dist[3], s_.dist[4]);
+
+    apriltag_family_t* tf = tag36h11_create();
+    for (int id = 0; id <= 5; ++id)
+    {
+        image_u8_t* im = apriltag_to_image(tf, id);
+        cv::Mat img(im->height, im->width, CV_8UC1, im->buf, im->stride);
+        tagImages_.push_back(img.clone());
+        image_u8_destroy(im);
+    }
+    tag36h11_destroy(tf);
+
+    // Same layout as registerTags() in main.cpp: corner 0 of tag 2-5 at
+    // (-h,-h), (h,-h), (h,h), (-h,h), each tag extending towards +x, +y
+    if (s_.calibSquare > 0.0)
+    {
+        const double h = s_.calibSquare / 2, c = s_.tagSize / 2;
+        const double corner[4][2] = { {-h, -h}, {h, -h}, {h, h}, {-h, h} };
+        for (int i = 0; i < 4; ++i)
+        {
+            const double wx = corner[i][0] + c, wy = corner[i][1] + c;
+            calibTags_.push_back({ 2 + i, facingCamera(0.0), { wx, -wy, s_.distance } });
+        }
+    }
+}
+
+SyntheticScene::~SyntheticScene() = default;
+
+cv::Mat SyntheticScene::K() const
+{
+    return (cv::Mat1d(3, 3) <<
+        s_.fx, 0.0,   s_.cx,
+        0.0,   s_.fy, s_.cy,
+        0.0,   0.0,   1.0);
+}
+
+std::vector<SceneTag> SyntheticScene::truth(int index) const
+{
+    const double t     = index / s_.fps;
+    const double theta = s_.omega * t;
+
+    // Small satellite drift so no two frames are identical
+    const double wobble = 0.005 * std::sin(0.7 * t);
+
+    return
+    {
+        { 0, facingCamera(0.2 * std::sin(0.5 * t)), { wobble, -wobble, s_.distance } },
+        { 1, facingCamera(theta),
+          { s_.orbitRadius * std::cos(theta), s_.orbitRadius * std::sin(theta), s_.distance } },
+    };
+}
+
+void SyntheticScene::drawTag(cv::Mat& gray, const SceneTag& tag) const
+{
+    // Black-border corners in tag-image pixel centres, in tagObjectPoints order
+    const float lo = TAG_BORDER_PX - 0.5f;
+    const float hi = TAG_IMAGE_PX - TAG_BORDER_PX - 0.5f;
+    const std::vector<cv::Point2f> src = { {lo, hi}, {hi, hi}, {hi, lo}, {lo, lo} };
+
+    const float h = static_cast<float>(s_.tagSize / 2);
+    const std::vector<cv::Point3f> obj = { {-h, -h, 0}, { h, -h, 0}, { h,  h, 0}, {-h,  h, 0} };
+    std::vector<cv::Point2f> dst;
+    cv::projectPoints(obj, tag.rvec, tag.tvec, K(), D_, dst);
+
+    // Distortion bends the edges slightly; over one tag a homography
+    // through the distorted corners is close enough and keeps them exact.
+    const cv::Mat H = cv::getPerspectiveTransform(src, dst);
+
+    // Only warp into the tag's bounding box (quiet zone included)
+    const float e0 = -0.5f, e1 = TAG_IMAGE_PX - 0.5f;
+    std::vector<cv::Point2f> outer = { {e0, e0}, {e1, e0}, {e1, e1}, {e0, e1} }, outerImg;
+    cv::perspectiveTransform(outer, outerImg, H);
+    const cv::Rect roi = cv::boundingRect(outerImg) & cv::Rect(0, 0, gray.cols, gray.rows);
+    if (roi.area() == 0) return;
+
+    const cv::Mat shift = (cv::Mat1d(3, 3) << 1, 0, -roi.x, 0, 1, -roi.y, 0, 0, 1);
+    cv::Mat view = gray(roi);
+    cv::warpPerspective(tagImages_[tag.id], view, shift * H, roi.size(),
+                        cv::INTER_NEAREST, cv::BORDER_TRANSPARENT);
+}
+
+void SyntheticScene::render(int index, cv::Mat& gray) const
+{
+    gray.create(s_.height, s_.width, CV_8UC1);
+    gray.setTo(SCENE_BACKGROUND);
+
+    for (const auto& tag : calibTags_)
+        drawTag(gray, tag);
+    for (const auto& tag : truth(index))
+        drawTag(gray, tag);
+
+    // Optics and sensor: slight blur, then Gaussian noise
+    cv::GaussianBlur(gray, gray, cv::Size(3, 3), 0.8);
+    if (s_.noise > 0.0)
+    {
+        cv::Mat noise(gray.size(), CV_16SC1);
+        cv::RNG rng(s_.seed * 1000003u + static_cast<uint32_t>(index));
+        rng.fill(noise, cv::RNG::NORMAL, 0.0, s_.noise);
+        cv::add(gray, noise, gray, cv::noArray(), CV_8U);
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// ============================================================
+// SYNTHETIC SCENE
+//
+// Renders tag36h11 tracking tags at known camera-frame poses onto a grey
+// background, so offline tools can measure pose error against ground
+// truth.  The satellite (tag 0) sits on the optical axis and the end
+// mass (tag 1) orbits it in the rig plane, both facing the camera.
+// Optionally calibration tags 2-5 are drawn where main.cpp expects them,
+// so the full tracker can calibrate against the scene.  Frames are a
+// pure function of their index; noise is seeded per frame.
+//
+// The camera looks straight down at the rig plane: world x is camera x,
+// world y is camera -y, and the world origin is on the optical axis.
+// ============================================================
+
+struct SceneSettings
+{
+    int    width       = 2028;     // rendered image size
+    int    height      = 1520;
+    double fx          = 2004.6;   // pinhole intrinsics at that size
+    double fy          = 2010.2;
+    double cx          = 1056.7;
+    double cy          = 734.5;
+    double dist[5]     = {};       // k1 k2 p1 p2 k3, applied to tag corners
+
+    double tagSize     = 0.056;    // metres, black border edge
+    double distance    = 1.2;      // camera to rig plane, metres
+    double calibSquare = 0.0;      // tags 2-5 at world (+-s/2, +-s/2), 0 = not drawn
+    double orbitRadius = 0.25;     // end mass around the satellite, metres
+    double omega       = 1.5;      // rad/s
+    double fps         = 30.0;     // frame index -> time
+    double noise       = 2.0;      // grey-level sigma
+    uint32_t seed      = 1;
+};
+
+struct SceneTag
+{
+    int       id;
+    cv::Vec3d rvec;   // tag -> camera, same convention as cv::solvePnP
+    cv::Vec3d tvec;   // metres
+};
+
+class SyntheticScene
+{
+public:
+    explicit SyntheticScene(const SceneSettings& settings);
+    ~SyntheticScene();
+
+    SyntheticScene(const SyntheticScene&)            = delete;
+    SyntheticScene& operator=(const SyntheticScene&) = delete;
+
+    const SceneSettings& settings() const { return s_; }
+    cv::Mat K() const;   // 3x3 CV_64F
+
+    // Ground truth for frame `index` (tracking tags only)
+    std::vector<SceneTag> truth(int index) const;
+
+    // Rig-plane position of a tag in the calibration tags' world frame
+    static cv::Point2d worldPosition(const SceneTag& tag)
+    {
+        return { tag.tvec[0], -tag.tvec[1] };
+    }
+
+    // CV_8UC1 image of frame `index`
+    void render(int index, cv::Mat& gray) const;
+
+private:
+    void drawTag(cv::Mat& gray, const SceneTag& tag) const;
+
+    SceneSettings         s_;
+    cv::Mat               D_;
+    std::vector<cv::Mat>  tagImages_;   // indexed by tag id (0 - 5)
+    std::vector<SceneTag> calibTags_;
+};
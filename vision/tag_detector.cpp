@@ -0,0 +1,99 @@
+#include "tag_detector.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <apriltag/tag36h11.h>
+
+// ============================================================
+// HELPERS
+// ============================================================
+
+// Clamp x to [0, 1]
+static inline double clamp01(double x)
+{
+    return std::max(0.0, std::min(1.0, x));
+}
+
+// ============================================================
+// CONFIDENCE SCORE
+//
+// Combines four signals:
+//
+//   1. decision_margin  – how unambiguous the bit pattern match was.
+//                         Higher = better.  Saturates at MARGIN_SAT.
+//
+//   2. hamming distance – number of bit-errors corrected.
+//                         0 → score 1.0,  1 → 0.5,  2 → 0.0.
+//                         (tag36h11 allows up to hamming=1 by default)
+//
+//   3. reprojection err – mean pixel error after solvePnP.
+//                         0 px → 1.0,  REPROJ_MAX px → 0.0.
+//
+//   4. tag pixel size   – larger apparent size = more detail = better.
+//                         Saturates at SIZE_SAT px diagonal (corner 0 to 2).
+//
+// Final score is a weighted sum, clamped to [0, 1].  The reprojection
+// error and diagonal are measured by PoseCore (pose_core.hpp).
+// ============================================================
+
+double confidenceScore(double decisionMargin, int hamming, double reprojErrPx, double diagonalPx)
+{
+    // --- 1. decision_margin score ---
+    double s_margin = clamp01(decisionMargin / MARGIN_SAT);
+
+    // --- 2. hamming score ---
+    double s_hamming;
+    switch (hamming)
+    {
+        case 0:  s_hamming = 1.00; break;
+        case 1:  s_hamming = 0.50; break;
+        default: s_hamming = 0.00; break;   // ≥2 errors → discard
+    }
+
+    // --- 3. reprojection error score ---
+    double s_reproj = clamp01(1.0 - reprojErrPx / REPROJ_MAX);
+
+    // --- 4. pixel size score ---
+    double s_size = clamp01(diagonalPx / SIZE_SAT);
+
+    // --- weighted sum ---
+    double confidence =
+        W_MARGIN  * s_margin  +
+        W_HAMMING * s_hamming +
+        W_REPROJ  * s_reproj  +
+        W_SIZE    * s_size;
+
+    return clamp01(confidence);
+}
+
+// ============================================================
+// APRILTAG DETECTOR
+// ============================================================
+
+apriltag_detector_t* createDetector(const DetectorSettings& settings)
+{
+    auto tf = tag36h11_create();
+    auto td = apriltag_detector_create();
+    apriltag_detector_add_family(td, tf);
+    td->quad_decimate  = static_cast<float>(settings.quadDecimate);
+    td->nthreads       = settings.nthreads;
+    td->refine_edges   = settings.refineEdges ? 1 : 0;
+    return td;
+}
+
+void destroyDetector(apriltag_detector_t* td)
+{
+    if (!td) return;
+    apriltag_family_t* tf = nullptr;
+    if (zarray_size(td->tag_families) > 0)
+        zarray_get(td->tag_families, 0, &tf);
+    apriltag_detector_destroy(td);
+    if (tf) tag36h11_destroy(tf);
+}
+
+std::array<cv::Point3f, 4> tagObjectPoints(double size)
+{
+    const float h = static_cast<float>(size / 2);
+    return {{ {-h, -h, 0}, { h, -h, 0}, { h,  h, 0}, {-h,  h, 0} }};
+}
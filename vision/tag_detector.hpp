@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include <apriltag/apriltag.h>
+
+// ============================================================
+// TAG DETECTOR
+//
+// AprilTag detector setup and the per-sighting confidence score, shared
+// by the tracker and the offline tools (param_sweep, the perf tests).
+// The pose math around them is in pose_core.hpp.
+// ============================================================
+
+struct DetectorSettings
+{
+    double quadDecimate = 2.0;
+    int    nthreads     = 4;
+    bool   refineEdges  = true;
+};
+
+// tag36h11 detector; free with destroyDetector()
+apriltag_detector_t* createDetector(const DetectorSettings& settings);
+void destroyDetector(apriltag_detector_t* td);
+
+// Confidence weights  (tune to your scene)
+constexpr double W_MARGIN           = 0.50;   // decision_margin weight
+constexpr double W_HAMMING          = 0.25;   // hamming penalty weight
+constexpr double W_REPROJ           = 0.15;   // reprojection-error weight
+constexpr double W_SIZE             = 0.10;   // tag pixel-size weight
+
+constexpr double MARGIN_SAT         = 80.0;   // margin value that maps to score 1.0
+constexpr double SIZE_SAT           = 200.0;  // pixel diagonal that maps to score 1.0
+constexpr double REPROJ_MAX         = 5.0;    // reprojection error (px) that maps to score 0.0
+
+// 3-D corners of a square tag of side `size` in its own frame (z = 0),
+// in the order AprilTag reports the image corners.
+std::array<cv::Point3f, 4> tagObjectPoints(double size);
+
+// Confidence in [0, 1] of one sighting from its decode quality, mean
+// reprojection error after solvePnP and corner 0-2 diagonal in pixels
+// (see tag_detector.cpp for the scoring).
+double confidenceScore(double decisionMargin, int hamming, double reprojErrPx, double diagonalPx);
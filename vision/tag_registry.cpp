@@ -0,0 +1,69 @@
+#include "tag_registry.hpp"
+
+#include <algorithm>
+
+// ============================================================
+// TAG REGISTRY
+// ============================================================
+
+TagRegistry::TagRegistry()
+{
+    role_.fill(Role::None);
+    slot_.fill(-1);
+}
+
+int TagRegistry::addTracking(int id, const std::string& name, double gate)
+{
+    if (id < 0 || id >= TAG_ID_LIMIT || role_[id] != Role::None) return -1;
+
+    const int s = static_cast<int>(trackIds.size());
+    trackIds.push_back(id);
+    trackNames.push_back(name);
+    maxJump.push_back(gate);
+
+    role_[id] = Role::Tracking;
+    slot_[id] = static_cast<int16_t>(s);
+    return s;
+}
+
+int TagRegistry::addCalibration(int id, const TagCorners3f& worldCorners)
+{
+    if (id < 0 || id >= TAG_ID_LIMIT || role_[id] != Role::None) return -1;
+
+    const int s = static_cast<int>(calibIds.size());
+    calibIds.push_back(id);
+    calibCorners.push_back(worldCorners);
+
+    role_[id] = Role::Calibration;
+    slot_[id] = static_cast<int16_t>(s);
+    return s;
+}
+
+int TagRegistry::trackSlot(int id) const
+{
+    if (id < 0 || id >= TAG_ID_LIMIT || role_[id] != Role::Tracking) return -1;
+    return slot_[id];
+}
+
+int TagRegistry::calibSlot(int id) const
+{
+    if (id < 0 || id >= TAG_ID_LIMIT || role_[id] != Role::Calibration) return -1;
+    return slot_[id];
+}
+
+// ============================================================
+// TRACK SET
+// ============================================================
+
+void TrackSet::resize(size_t n)
+{
+    pose.resize(n);
+    confidence.resize(n, 0.0);
+    visible.resize(n, 0);
+    corners.resize(n);
+}
+
+void TrackSet::clearVisibility()
+{
+    std::fill(visible.begin(), visible.end(), 0);
+}
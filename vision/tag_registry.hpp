@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// ============================================================
+// TAG REGISTRY
+//
+// Maps AprilTag IDs to dense slots so every per-detection lookup is a
+// single array index.  Tracking and calibration tags each own a slot
+// range; per-tag data lives in flat arrays indexed by that slot.
+// ============================================================
+
+constexpr int TAG_ID_LIMIT = 587;   // number of codes in tag36h11
+
+struct Pose
+{
+    double x   = 0.0;
+    double y   = 0.0;
+    double yaw = 0.0;   // degrees
+};
+
+using TagCorners2f = std::array<cv::Point2f, 4>;
+using TagCorners3f = std::array<cv::Point3f, 4>;
+
+class TagRegistry
+{
+public:
+    TagRegistry();
+
+    // Returns the new slot, or -1 if the ID is out of range / already used.
+    int addTracking(int id, const std::string& name, double maxJump);
+    int addCalibration(int id, const TagCorners3f& worldCorners);
+
+    // O(1) ID -> slot lookups; -1 when the ID has a different role.
+    int trackSlot(int id) const;
+    int calibSlot(int id) const;
+
+    size_t trackCount() const { return trackIds.size(); }
+    size_t calibCount() const { return calibIds.size(); }
+
+    // Tracking tags, indexed by track slot
+    std::vector<int>          trackIds;
+    std::vector<std::string>  trackNames;
+    std::vector<double>       maxJump;       // jump gate, metres
+
+    // Calibration tags, indexed by calib slot
+    std::vector<int>          calibIds;
+    std::vector<TagCorners3f> calibCorners;  // world frame
+
+private:
+    enum class Role : uint8_t { None, Tracking, Calibration };
+
+    std::array<Role,    TAG_ID_LIMIT> role_;
+    std::array<int16_t, TAG_ID_LIMIT> slot_;
+};
+
+// ============================================================
+// TRACK SET
+//
+// State of every tracked tag for one frame, one array per field.
+// Sized once from the registry; copying between equally sized sets
+// reuses the existing storage.
+// ============================================================
+
+struct TrackSet
+{
+    std::vector<Pose>         pose;
+    std::vector<double>       confidence;   // [0 .. 1]
+    std::vector<uint8_t>      visible;
+    std::vector<TagCorners2f> corners;
+
+    void   resize(size_t n);
+    size_t size() const { return pose.size(); }
+
+    // Keep last pose/confidence but mark every tag as not seen this frame.
+    void   clearVisibility();
+};
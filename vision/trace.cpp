@@ -0,0 +1,190 @@
+#include "trace.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+
+#include "async_logger.hpp"
+
+std::atomic<bool> traceOn(false);
+
+struct TraceEvent
+{
+    const char* name;
+    uint64_t    seq;
+    uint64_t    frame;
+    int64_t     beginNs;
+    int64_t     endNs;
+};
+
+struct ThreadBuffer
+{
+    std::string             name;
+    int                     tid = 0;
+    std::vector<TraceEvent> events;   // power-of-two ring
+    std::atomic<uint64_t>   head{0};
+};
+
+static std::mutex                                 registryMutex;
+static std::vector<std::unique_ptr<ThreadBuffer>> registry;   // never shrinks while tracing
+static std::string                                tracePath;
+static size_t                                     ringSize = 0;
+static int64_t                                    originNs = 0;
+
+static std::atomic<bool> dumpRequested(false);
+static std::atomic<bool> watcherStop(false);
+static std::thread       watcher;
+
+static thread_local ThreadBuffer* localBuffer = nullptr;
+static thread_local std::string   localName;
+
+static ThreadBuffer* threadBuffer()
+{
+    if (localBuffer) return localBuffer;
+
+    auto buf = std::make_unique<ThreadBuffer>();
+    buf->events.resize(ringSize);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buf->tid  = static_cast<int>(registry.size()) + 1;
+    buf->name = localName.empty() ? "thread " + std::to_string(buf->tid) : localName;
+    localBuffer = buf.get();
+    registry.push_back(std::move(buf));
+    return localBuffer;
+}
+
+static void onSigusr1(int)
+{
+    dumpRequested = true;
+}
+
+// JSON-escape the few characters thread names could contain
+static std::string jsonString(const std::string& s)
+{
+    std::string out;
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static bool dump()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    FILE* f = std::fopen(tracePath.c_str(), "w");
+    if (!f)
+    {
+        logError("Cannot write trace %s", tracePath.c_str());
+        return false;
+    }
+
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"apriltag_demo\"}}");
+
+    size_t total = 0;
+    for (const auto& buf : registry)
+    {
+        std::fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                        "\"args\":{\"name\":\"%s\"}}",
+                     buf->tid, jsonString(buf->name).c_str());
+
+        // Events still being overwritten while the tracker runs may be
+        // torn; a dump at traceStop() is exact.
+        const uint64_t head  = buf->head.load(std::memory_order_acquire);
+        const uint64_t first = head > ringSize ? head - ringSize : 0;
+        for (uint64_t i = first; i < head; ++i)
+        {
+            const TraceEvent& e = buf->events[i & (ringSize - 1)];
+            std::fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                            "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"seq\":%llu,\"frame\":%llu}}",
+                         e.name, buf->tid,
+                         (e.beginNs - originNs) / 1000.0, (e.endNs - e.beginNs) / 1000.0,
+                         static_cast<unsigned long long>(e.seq),
+                         static_cast<unsigned long long>(e.frame));
+        }
+        total += head - first;
+    }
+
+    std::fprintf(f, "\n]}\n");
+    std::fclose(f);
+
+    logInfo("Trace written to %s (%zu events, %zu threads)",
+            tracePath.c_str(), total, registry.size());
+    return true;
+}
+
+static void watcherLoop()
+{
+    while (!watcherStop)
+    {
+        if (dumpRequested.exchange(false)) dump();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}
+
+// ============================================================
+// TRACE
+// ============================================================
+
+int64_t traceNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool traceStart(const std::string& path, size_t eventsPerThread)
+{
+    if (traceOn) return false;
+
+    ringSize = 1;
+    while (ringSize < eventsPerThread) ringSize <<= 1;
+    tracePath = path;
+    originNs  = traceNowNs();
+
+    std::signal(SIGUSR1, onSigusr1);
+    watcherStop = false;
+    watcher     = std::thread(watcherLoop);
+
+    traceOn = true;
+    logInfo("Tracing to %s (SIGUSR1 writes a snapshot)", path.c_str());
+    return true;
+}
+
+void traceStop()
+{
+    if (!traceOn) return;
+    traceOn = false;
+
+    watcherStop = true;
+    if (watcher.joinable()) watcher.join();
+    dump();
+}
+
+void traceThread(const std::string& name)
+{
+    localName = name;
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());   // shows in /proc
+    if (localBuffer)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        localBuffer->name = name;
+    }
+}
+
+void traceRecord(const char* name, int64_t beginNs, int64_t endNs,
+                 uint64_t seq, uint64_t frame)
+{
+    ThreadBuffer* buf = threadBuffer();
+    const uint64_t h  = buf->head.load(std::memory_order_relaxed);
+    buf->events[h & (ringSize - 1)] = { name, seq, frame, beginNs, endNs };
+    buf->head.store(h + 1, std::memory_order_release);
+}
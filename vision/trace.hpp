@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// ============================================================
+// TRACE
+//
+// Opt-in timeline of pipeline stages, written as a Chrome / Perfetto
+// JSON trace (open in ui.perfetto.dev or chrome://tracing).
+//
+// Each thread records complete events into its own fixed ring (single
+// writer, no locks, no allocation after the first event); the oldest
+// events are overwritten when a ring wraps.  The trace file is written
+// at traceStop() and whenever the process receives SIGUSR1:
+//   kill -USR1 $(pidof apriltag_demo)
+//
+// Scopes carry the camera frame sequence number and, once assigned, the
+// tracker frame id, so a frame can be followed from capture through
+// tracking and publishing.
+// ============================================================
+
+extern std::atomic<bool> traceOn;
+
+bool traceStart(const std::string& path, size_t eventsPerThread = 1 << 16);
+void traceStop();
+
+// Name the calling thread in the trace and the OS (e.g. "tracking cam0";
+// the OS name is cut to 15 characters).
+void traceThread(const std::string& name);
+
+void traceRecord(const char* name, int64_t beginNs, int64_t endNs,
+                 uint64_t seq, uint64_t frame);
+
+int64_t traceNowNs();
+
+class TraceScope
+{
+public:
+    // `name` must be a string literal (only the pointer is stored)
+    explicit TraceScope(const char* name, uint64_t seq = 0, uint64_t frame = 0)
+        : name_(name), seq_(seq), frame_(frame),
+          begin_(traceOn.load(std::memory_order_acquire) ? traceNowNs() : 0)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (begin_) traceRecord(name_, begin_, traceNowNs(), seq_, frame_);
+    }
+
+    TraceScope(const TraceScope&)            = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    uint64_t    seq_;
+    uint64_t    frame_;
+    int64_t     begin_;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "camera.hpp"
+#include "config.hpp"
+#include "pose_history.hpp"
+
+// ============================================================
+// TRACKER ENTRY POINTS
+//
+// main() and the Python module (tracker_py.cpp) both drive the tracker
+// through these.  main.cpp is compiled with TRACKER_NO_MAIN when it is
+// linked into another program.  The tracker can be started once per
+// process.
+// ============================================================
+
+struct TrackerOptions
+{
+    std::string recordPath;     // --record <file>
+    std::string replayPath;     // --replay <file>
+    std::string clipDir;        // --clip-dir <dir>
+    std::string trajPath;       // --traj-log <file>
+    std::string tracePath;      // --trace <file.json>
+    std::string controlSpec;    // --control <spec>, see control.hpp
+    std::vector<std::string> publish;   // --publish <spec>, after the bridge
+    int    wsPort      = 0;     // --ws-port <port>
+    double wsMaxHz     = 30.0;  // --ws-max-hz <hz>
+    int    metricsPort = 0;     // --metrics-port <port>
+    bool   visualise   = true;  // --headless / --no-vis turns the OpenCV windows off
+    double visHz       = 15.0;  // --vis-hz <hz>, OpenCV window redraw rate
+    int    previewPort = 0;     // --preview-port <port>, MJPEG preview
+    double previewHz   = 2.0;   // --preview-hz <hz>
+    bool   allocStrict = false; // --alloc-strict (ALLOC_TRACKING builds)
+    bool   perfCounters = false; // --perf-counters
+    bool   captureThread = false; // --capture-thread: pull loop instead of the appsink callback
+    size_t historyRows = 0;     // in-process pose history (0 = none)
+    TrackerConfig config;       // --profile / --config / --<setting>
+};
+
+// Fills opts from the command line; logging flags are applied directly.
+// False (after logging why) on a bad profile, config file or setting.
+bool parseTrackerArgs(int argc, char** argv, TrackerOptions& opts);
+
+// Returns once threads run.  On false some may already have started:
+// call stopTracker() before exiting.
+bool startTracker(const TrackerOptions& opts);
+void waitTracker();                              // until 'q' / replay end / stop
+void stopTracker();                              // stop, join, close outputs
+bool trackerRunning();
+
+const std::vector<int>& trackedTagIds();
+
+// One control-channel command (control.hpp) run in-process, without
+// --control; returns the reply the channel would send
+std::string trackerCommand(const std::vector<std::string>& words);
+
+// Camera and rig geometry of the running tracker (the defaults before
+// startTracker), for tools that render frames the tracker will accept
+// and calibrate against (perf_budget)
+struct TrackerSetup
+{
+    CameraSpec camera;        // CAMERA_SPECS[0], full resolution
+    int        width;         // capture size, SENSOR / resolution_divider
+    int        height;
+    double     tagSize;       // tag_size
+    double     calibSquare;   // calib_square
+};
+
+TrackerSetup trackerSetup();
+
+// Set by startTracker() when opts.historyRows > 0
+extern std::shared_ptr<PoseHistory> poseHistory;
@@ -0,0 +1,182 @@
+// ============================================================
+// tracker_bench — fixed-rig versus runtime pose variant
+//
+// Times PoseCore<FixedRig<ProductionRig>> against PoseCore<DynamicRig>
+// (pose_core.hpp) on the same sightings and checks they agree.  The
+// sightings are the synthetic orbit's tracking tags (synthetic_scene.hpp)
+// projected with the production rig's intrinsics and distortion, plus
+// corner noise; no image is rendered, so only the pose stage is timed.
+//
+//   tracker_bench                       1000 frames, best of 5 passes
+//   tracker_bench --frames 5000 --reps 10 --noise 0.5
+//
+// Options:
+//   --frames <n>    orbit frames, two sightings each      (1000)
+//   --reps <n>      timed passes per variant, best kept   (5)
+//   --noise <px>    corner noise sigma                    (0.3)
+//
+// Prints ns per sighting for both variants and the largest pose and
+// confidence difference between them; exits 1 if they disagree by more
+// than rounding.
+// ============================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include <apriltag/apriltag.h>
+
+#include "pose_core.hpp"
+#include "production_rig.hpp"
+#include "synthetic_scene.hpp"
+#include "tag_registry.hpp"
+
+constexpr double MAX_POSE_DIFF_M   = 1e-6;
+constexpr double MAX_YAW_DIFF_DEG  = 1e-4;
+constexpr double MAX_CONF_DIFF     = 1e-6;
+
+// ============================================================
+// SIGHTINGS
+// ============================================================
+
+// Tracking-tag detections of the synthetic orbit as the detector would
+// report them: corners in tagObjectPoints order, clean decode
+static std::vector<apriltag_detection_t> makeDetections(int frames, double noise)
+{
+    SceneSettings s;
+    s.width   = ProductionRig::WIDTH;
+    s.height  = ProductionRig::HEIGHT;
+    s.fx      = ProductionRig::FX;
+    s.fy      = ProductionRig::FY;
+    s.cx      = ProductionRig::CX;
+    s.cy      = ProductionRig::CY;
+    s.tagSize = ProductionRig::TAG_SIZE;
+    const double dist[5] = { ProductionRig::K1, ProductionRig::K2, ProductionRig::P1,
+                             ProductionRig::P2, ProductionRig::K3 };
+    std::copy(dist, dist + 5, s.dist);
+    SyntheticScene scene(s);
+
+    const cv::Mat D(1, 5, CV_64F, const_cast<double*>(dist));
+    const std::array<cv::Point3f, 4> obj = tagObjectPoints(s.tagSize);
+
+    cv::RNG rng(s.seed);
+    std::vector<apriltag_detection_t> dets;
+    std::vector<cv::Point2f> img;
+    for (int f = 0; f < frames; ++f)
+    {
+        for (const SceneTag& tag : scene.truth(f))
+        {
+            cv::projectPoints(obj, tag.rvec, tag.tvec, scene.K(), D, img);
+
+            apriltag_detection_t det{};
+            det.id              = tag.id;
+            det.hamming         = 0;
+            det.decision_margin = 60.0f;
+            for (int k = 0; k < 4; ++k)
+            {
+                det.p[k][0] = img[k].x + rng.gaussian(noise);
+                det.p[k][1] = img[k].y + rng.gaussian(noise);
+            }
+            dets.push_back(det);
+        }
+    }
+    return dets;
+}
+
+// ============================================================
+// TIMING
+// ============================================================
+
+// Best-of-`reps` ns per sighting; `out` holds the last pass's results
+template <class Core>
+static double timeCore(const Core& core, const std::vector<apriltag_detection_t>& dets,
+                       int reps, std::vector<TagSighting>& out)
+{
+    out.resize(dets.size());
+    double best = INFINITY;
+    for (int r = 0; r < reps; ++r)
+    {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < dets.size(); ++i)
+            if (core.trackSlot(dets[i].id) >= 0) core.solve(&dets[i], out[i]);
+        const auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count());
+    }
+    return dets.empty() ? 0.0 : best / dets.size();
+}
+
+// ============================================================
+// MAIN
+// ============================================================
+
+int main(int argc, char** argv)
+{
+    int    frames = 1000, reps = 5;
+    double noise  = 0.3;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if      (arg == "--frames" && i + 1 < argc) frames = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--reps"   && i + 1 < argc) reps   = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--noise"  && i + 1 < argc) noise  = std::max(0.0, std::atof(argv[++i]));
+        else
+        {
+            std::fprintf(stderr, "unknown option %s (see tracker_bench.cpp)\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    const std::vector<apriltag_detection_t> dets = makeDetections(frames, noise);
+
+    // The runtime variant configured as the production rig
+    TagRegistry tags;
+    for (int id : ProductionRig::TAG_IDS)
+        tags.addTracking(id, "tag" + std::to_string(id), 0.0);
+    const cv::Mat K = (cv::Mat_<double>(3, 3) << ProductionRig::FX, 0, ProductionRig::CX,
+                                                 0, ProductionRig::FY, ProductionRig::CY,
+                                                 0, 0, 1);
+    const cv::Mat D = (cv::Mat_<double>(1, 5) << ProductionRig::K1, ProductionRig::K2,
+                                                 ProductionRig::P1, ProductionRig::P2,
+                                                 ProductionRig::K3);
+
+    PoseCore<DynamicRig>              dynamicCore(DynamicRig(K, D, ProductionRig::TAG_SIZE, &tags));
+    PoseCore<FixedRig<ProductionRig>> fixedCore;
+
+    // Camera -> world of the scene: x kept, y and z flipped, origin on the
+    // rig plane below the camera
+    const cv::Mat R = (cv::Mat_<double>(3, 3) << 1, 0, 0, 0, -1, 0, 0, 0, -1);
+    const cv::Mat t = (cv::Mat_<double>(3, 1) << 0, 0, SceneSettings().distance);
+    dynamicCore.setCalibration(R, t);
+    fixedCore.setCalibration(R, t);
+
+    std::vector<TagSighting> dynOut, fixOut;
+    const double dynNs = timeCore(dynamicCore, dets, reps, dynOut);
+    const double fixNs = timeCore(fixedCore,   dets, reps, fixOut);
+
+    double poseDiff = 0.0, yawDiff = 0.0, confDiff = 0.0;
+    for (size_t i = 0; i < dets.size(); ++i)
+    {
+        poseDiff = std::max(poseDiff, std::hypot(dynOut[i].pose.x - fixOut[i].pose.x,
+                                                 dynOut[i].pose.y - fixOut[i].pose.y));
+        yawDiff  = std::max(yawDiff,  std::fabs(dynOut[i].pose.yaw - fixOut[i].pose.yaw));
+        confDiff = std::max(confDiff, std::fabs(dynOut[i].confidence - fixOut[i].confidence));
+    }
+
+    std::printf("%zu sightings, best of %d\n", dets.size(), reps);
+    std::printf("  runtime  %9.0f ns/sighting\n", dynNs);
+    std::printf("  fixed    %9.0f ns/sighting  (%.2fx)\n", fixNs, fixNs > 0.0 ? dynNs / fixNs : 0.0);
+    std::printf("  max diff %.3g m, %.3g deg, conf %.3g\n", poseDiff, yawDiff, confDiff);
+
+    if (poseDiff > MAX_POSE_DIFF_M || yawDiff > MAX_YAW_DIFF_DEG || confDiff > MAX_CONF_DIFF)
+    {
+        std::printf("FAIL: variants disagree\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,454 @@
+// ============================================================
+// tracker_checks — behaviour checks for tracker components
+//
+// Registered with CMake's CTest (see CMakeLists.txt), one check per run:
+//
+//   tracker_checks fusion
+//       Two cameras with different camera -> world rotations see the
+//       synthetic orbit's tags (synthetic_scene.hpp); each camera's pose
+//       core must report world yaw, and the fused track must match the
+//       scene's world pose.
+//
+//   tracker_checks pose-cache
+//       SightingCache (pose_core.hpp) on the synthetic scene with a still
+//       satellite and an orbiting end mass: the satellite is reused, the
+//       end mass re-solved every frame; drift past pose_cache_px forces
+//       a re-solve, and a hamming change, clear() and pose_cache_px = 0
+//       all bypass the cache.
+//
+//   tracker_checks orbit
+//       OrbitModel (orbit_model.hpp) on a noisy simulated spin: lock is
+//       taken mid-spin faster than the fixed jump gate allows, the gate
+//       widens with the rate, outliers are rejected, and lock is dropped
+//       after ORBIT_TIMEOUT_S and reacquired on a new spin.
+//
+// Exit status: 0 pass, 1 a check failed, 2 usage error.  Every failed
+// expectation prints one FAIL line.
+// ============================================================
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include <apriltag/apriltag.h>
+
+#include "fusion.hpp"
+#include "orbit_model.hpp"
+#include "pose_core.hpp"
+#include "synthetic_scene.hpp"
+#include "tag_detector.hpp"
+#include "tag_registry.hpp"
+
+constexpr double MAX_POS_ERR_M   = 2e-3;
+constexpr double MAX_YAW_ERR_DEG = 0.5;
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what)
+{
+    if (ok) return;
+    std::printf("FAIL: %s\n", what);
+    ++failures;
+}
+
+static double yawDiffDeg(double a, double b)
+{
+    return std::fabs(std::remainder(a - b, 360.0));
+}
+
+static cv::Matx33d rotZ(double deg)
+{
+    const double r = deg * CV_PI / 180.0, c = std::cos(r), s = std::sin(r);
+    return cv::Matx33d(c, -s, 0, s, c, 0, 0, 0, 1);
+}
+
+// ============================================================
+// RIG
+// ============================================================
+
+// A camera looking straight down at the rig plane from `height`, turned
+// by `turnDeg` about the vertical and standing over (x, y)
+struct TestCamera
+{
+    cv::Matx33d R;   // camera -> world, as calibrate() stores it
+    cv::Vec3d   t;
+};
+
+static TestCamera downwardCamera(double turnDeg, double x, double y, double height)
+{
+    const cv::Matx33d flip(1, 0, 0, 0, -1, 0, 0, 0, -1);   // synthetic_scene's camera
+    return { rotZ(turnDeg) * flip, cv::Vec3d(x, y, height) };
+}
+
+// The detection `cam` makes of a tag at world rotation Rw / position pw
+static apriltag_detection_t detectionFor(const SyntheticScene& scene, const TestCamera& cam,
+                                         int id, const cv::Matx33d& Rw, const cv::Vec3d& pw)
+{
+    const SceneSettings& s = scene.settings();
+    const cv::Matx33d Rc = cam.R.t() * Rw;
+    const cv::Vec3d   tc = cam.R.t() * (pw - cam.t);
+    cv::Vec3d rvec;
+    cv::Rodrigues(Rc, rvec);
+
+    std::vector<cv::Point2f> img;
+    const cv::Mat D(1, 5, CV_64F, const_cast<double*>(s.dist));
+    cv::projectPoints(tagObjectPoints(s.tagSize), rvec, tc, scene.K(), D, img);
+
+    apriltag_detection_t det{};
+    det.id              = id;
+    det.hamming         = 0;
+    det.decision_margin = 60.0f;
+    for (int k = 0; k < 4; ++k)
+    {
+        det.p[k][0] = img[k].x;
+        det.p[k][1] = img[k].y;
+    }
+    return det;
+}
+
+// A scene tag (tag -> scene camera) in the world frame of `cam`
+struct WorldTag
+{
+    cv::Matx33d R;     // tag -> world
+    cv::Vec3d   p;
+    double      yaw;   // degrees
+};
+
+static WorldTag worldTag(const TestCamera& cam, const SceneTag& tag)
+{
+    cv::Matx33d Rt;
+    cv::Rodrigues(tag.rvec, Rt);
+    WorldTag w;
+    w.R   = cam.R * Rt;
+    w.p   = cam.R * tag.tvec + cam.t;
+    w.yaw = std::atan2(w.R(1, 0), w.R(0, 0)) * 180.0 / CV_PI;
+    return w;
+}
+
+// ============================================================
+// FUSION
+// ============================================================
+
+static int checkFusion()
+{
+    SceneSettings s;
+    SyntheticScene scene(s);
+    const cv::Mat D(1, 5, CV_64F, s.dist);
+
+    TagRegistry tags;
+    tags.addTracking(0, "tag0", 0.2);
+    tags.addTracking(1, "tag1", 0.2);
+
+    // The scene's own camera and one turned 70 degrees, off to the side
+    const TestCamera cams[2] = { downwardCamera(0.0, 0.0, 0.0, s.distance),
+                                 downwardCamera(70.0, 0.15, -0.10, s.distance) };
+
+    std::vector<PoseCore<DynamicRig>> cores;
+    for (const TestCamera& cam : cams)
+    {
+        cores.emplace_back(DynamicRig(scene.K(), D, s.tagSize, &tags));
+        cores.back().setCalibration(cv::Mat(cam.R), cv::Mat(cam.t));
+    }
+
+    TrackFusion fusion;
+    fusion.reset(2, tags.trackCount(), 0.05);
+    TrackSet observed[2], fused;
+    for (auto& ts : observed) ts.resize(tags.trackCount());
+    fused.resize(tags.trackCount());
+
+    for (int frame = 0; frame < 60; frame += 6)
+    {
+        const double stamp = frame / s.fps;
+        for (int c = 0; c < 2; ++c) observed[c].clearVisibility();
+
+        const std::vector<SceneTag> truth = scene.truth(frame);
+        for (const SceneTag& tag : truth)
+        {
+            const int slot = tags.trackSlot(tag.id);
+            const WorldTag w = worldTag(cams[0], tag);
+
+            for (int c = 0; c < 2; ++c)
+            {
+                const apriltag_detection_t det = detectionFor(scene, cams[c], tag.id, w.R, w.p);
+                TagSighting sighting;
+                cores[c].solve(&det, sighting);
+
+                expect(std::hypot(sighting.pose.x - w.p[0], sighting.pose.y - w.p[1]) < MAX_POS_ERR_M,
+                       "camera sighting has the world position");
+                expect(yawDiffDeg(sighting.pose.yaw, w.yaw) < MAX_YAW_ERR_DEG,
+                       "camera sighting has the world yaw");
+
+                observed[c].pose[slot]       = sighting.pose;
+                observed[c].confidence[slot] = sighting.confidence;
+                observed[c].visible[slot]    = 1;
+            }
+        }
+
+        fusion.update(0, stamp, observed[0], fused);
+        fusion.update(1, stamp, observed[1], fused);
+
+        for (const SceneTag& tag : truth)
+        {
+            const int slot = tags.trackSlot(tag.id);
+            const WorldTag w = worldTag(cams[0], tag);
+
+            expect(fused.visible[slot] != 0, "fused tag visible");
+            expect(std::hypot(fused.pose[slot].x - w.p[0], fused.pose[slot].y - w.p[1]) < MAX_POS_ERR_M,
+                   "fused position matches the world position");
+            expect(yawDiffDeg(fused.pose[slot].yaw, w.yaw) < MAX_YAW_ERR_DEG,
+                   "fused yaw matches the world yaw");
+        }
+    }
+    return failures ? 1 : 0;
+}
+
+// ============================================================
+// POSE CACHE
+// ============================================================
+
+constexpr double CACHE_PX = 1.0;   // pose_cache_px for the check
+
+// The tracker's per-tag step: reuse, or solve and store.  True on a hit.
+static bool cachedSolve(const PoseCore<DynamicRig>& core, SightingCache& cache, int slot,
+                        const apriltag_detection_t& det, double maxMovePx, TagSighting& out)
+{
+    if (cache.reuse(slot, &det, maxMovePx, out)) return true;
+    core.solve(&det, out);
+    cache.store(slot, &det, out);
+    return false;
+}
+
+static void shiftCorners(apriltag_detection_t& det, double dx, double dy)
+{
+    for (int k = 0; k < 4; ++k)
+    {
+        det.p[k][0] += dx;
+        det.p[k][1] += dy;
+    }
+}
+
+static int checkPoseCache()
+{
+    SceneSettings s;
+    SyntheticScene scene(s);
+    const cv::Mat D(1, 5, CV_64F, s.dist);
+
+    TagRegistry tags;
+    tags.addTracking(0, "satellite", 0.2);
+    tags.addTracking(1, "end_mass", 0.2);
+    const int sat = tags.trackSlot(0), end = tags.trackSlot(1);
+
+    const TestCamera cam = downwardCamera(0.0, 0.0, 0.0, s.distance);
+    PoseCore<DynamicRig> core(DynamicRig(scene.K(), D, s.tagSize, &tags));
+    core.setCalibration(cv::Mat(cam.R), cv::Mat(cam.t));
+
+    // Frame 0's satellite stands still throughout; the end mass orbits
+    const WorldTag satWorld = worldTag(cam, scene.truth(0)[0]);
+    const apriltag_detection_t satDet = detectionFor(scene, cam, 0, satWorld.R, satWorld.p);
+
+    SightingCache cache;
+    cache.resize(tags.trackCount());
+    TagSighting first, sighting;
+    expect(!cachedSolve(core, cache, sat, satDet, CACHE_PX, first), "first sighting is solved");
+
+    int satHits = 0, endHits = 0;
+    const int frames = 30;
+    for (int frame = 1; frame <= frames; ++frame)
+    {
+        satHits += cachedSolve(core, cache, sat, satDet, CACHE_PX, sighting);
+        expect(sighting.pose.x == first.pose.x && sighting.pose.y == first.pose.y &&
+               sighting.pose.yaw == first.pose.yaw && sighting.confidence == first.confidence,
+               "reused satellite pose is the solved one");
+
+        for (const SceneTag& tag : scene.truth(frame))
+        {
+            if (tag.id != 1) continue;
+            const WorldTag w = worldTag(cam, tag);
+            const apriltag_detection_t det = detectionFor(scene, cam, tag.id, w.R, w.p);
+            endHits += cachedSolve(core, cache, end, det, CACHE_PX, sighting);
+            expect(std::hypot(sighting.pose.x - w.p[0], sighting.pose.y - w.p[1]) < MAX_POS_ERR_M,
+                   "moving end mass has its current position");
+        }
+    }
+    expect(satHits == frames, "still satellite reused every frame");
+    expect(endHits == 0, "moving end mass solved every frame");
+
+    // Slow drift: compared with the last solve, so it adds up to a re-solve
+    const double step = 0.3;   // px per frame
+    apriltag_detection_t drift = satDet;
+    std::vector<int> solvedAt;
+    for (int frame = 1; frame <= 8; ++frame)
+    {
+        shiftCorners(drift, step, 0.0);
+        if (!cachedSolve(core, cache, sat, drift, CACHE_PX, sighting)) solvedAt.push_back(frame);
+    }
+    expect(solvedAt == std::vector<int>({ 4, 8 }), "drift past pose_cache_px forces a re-solve");
+
+    // Back at rest for the bypass cases
+    expect(!cachedSolve(core, cache, sat, satDet, CACHE_PX, sighting), "return from drift is solved");
+    expect(cachedSolve(core, cache, sat, satDet, CACHE_PX, sighting), "still tag reused again");
+
+    apriltag_detection_t flipped = satDet;
+    flipped.hamming = 1;
+    expect(!cachedSolve(core, cache, sat, flipped, CACHE_PX, sighting), "hamming change bypasses the cache");
+    expect(!cachedSolve(core, cache, sat, satDet, CACHE_PX, sighting), "hamming change back bypasses it too");
+
+    cache.clear();   // as on recalibration
+    expect(!cachedSolve(core, cache, sat, satDet, CACHE_PX, sighting), "clear() bypasses the cache");
+
+    expect(!cachedSolve(core, cache, sat, satDet, 0.0, sighting), "pose_cache_px = 0 bypasses the cache");
+    expect(!cachedSolve(core, cache, sat, satDet, 0.0, sighting), "pose_cache_px = 0 never reuses");
+
+    const uint64_t expectedSolves = 1 + frames + solvedAt.size() + 6;
+    expect(cache.solves() == expectedSolves, "every miss counted as a solve");
+    expect(cache.hits() == static_cast<uint64_t>(satHits) + (8 - solvedAt.size()) + 1,
+           "every reuse counted as a hit");
+    return failures ? 1 : 0;
+}
+
+// ============================================================
+// ORBIT MODEL
+// ============================================================
+
+constexpr double ORBIT_FPS       = 30.0;
+constexpr double ORBIT_TETHER    = 0.25;   // metres
+constexpr double ORBIT_BASE_GATE = 0.05;   // jump gate at rest, metres
+constexpr double ORBIT_NOISE_M   = 0.002;  // position noise, sigma
+constexpr double ORBIT_MAX_ERR_M = 0.015;  // settled prediction error
+
+static Pose satellitePose()
+{
+    Pose p;
+    p.x = 0.1;
+    p.y = 0.2;
+    return p;
+}
+
+// End mass at angle `a` (rad) about the satellite
+static Pose endMassPose(double a, double r = ORBIT_TETHER)
+{
+    Pose p = satellitePose();
+    p.x += r * std::cos(a);
+    p.y += r * std::sin(a);
+    return p;
+}
+
+// `frames` noisy frames of a spin at `omega` from angle a0 at stamp t0,
+// gated the way isPlausibleJump gates the end mass.  Returns the
+// rejections; maxErr is against the noise-free position.
+static int spin(OrbitModel& m, double t0, double a0, double omega, int frames, double& maxErr)
+{
+    std::mt19937 rng(1);
+    std::normal_distribution<double> noise(0.0, ORBIT_NOISE_M);
+
+    int rejected = 0;
+    for (int f = 0; f < frames; ++f)
+    {
+        const double t     = t0 + f / ORBIT_FPS;
+        const Pose   truth = endMassPose(a0 + omega * (t - t0));
+        Pose sat = satellitePose(), end = truth;
+        sat.x += noise(rng);
+        sat.y += noise(rng);
+        end.x += noise(rng);
+        end.y += noise(rng);
+
+        OrbitPrediction p;
+        if (m.predict(t, ORBIT_BASE_GATE, p))
+            maxErr = std::max(maxErr, std::hypot(truth.x - p.x, truth.y - p.y));
+
+        if (m.locked(t) && !m.accepts(t, ORBIT_BASE_GATE, end))
+        {
+            ++rejected;
+            continue;
+        }
+        m.update(t, sat, end);
+    }
+    return rejected;
+}
+
+static int checkOrbit()
+{
+    const int    frames = 60;
+    const double t0 = 100.0, dt = 1.0 / ORBIT_FPS;
+    const double tEnd = t0 + (frames - 1) * dt;
+
+    // Lock taken mid-spin, far faster than the fixed jump gate allows
+    expect(20.0 * ORBIT_TETHER * dt > ORBIT_BASE_GATE, "fast spin outruns the fixed jump gate");
+    OrbitModel fast;
+    double fastErr = 0.0;
+    expect(spin(fast, t0, 0.3, 20.0, frames, fastErr) == 0, "lock taken mid-spin, nothing rejected");
+    expect(fast.locked(tEnd), "locked after a fast spin");
+    expect(std::fabs(fast.omega() - 20.0) < 0.5, "rate settles at the spin rate");
+    expect(std::fabs(fast.radius() - ORBIT_TETHER) < 2e-3, "radius settles at the tether length");
+    expect(fastErr < ORBIT_MAX_ERR_M, "settled predictions follow the end mass");
+    std::printf("orbit: fast spin omega %.2f rad/s, radius %.4f m, max prediction error %.1f mm\n",
+                fast.omega(), fast.radius(), fastErr * 1e3);
+
+    // Gate widens with the rate
+    OrbitModel slow;
+    double slowErr = 0.0;
+    expect(spin(slow, t0, 0.3, 2.0, frames, slowErr) == 0, "slow spin, nothing rejected");
+
+    OrbitPrediction now, slowNext, fastNext;
+    expect(fast.predict(tEnd, ORBIT_BASE_GATE, now), "prediction at the last update");
+    expect(std::fabs(now.gate - ORBIT_BASE_GATE) < 1e-12, "gate is the jump gate at zero elapsed time");
+    expect(slow.predict(tEnd + dt, ORBIT_BASE_GATE, slowNext) &&
+           fast.predict(tEnd + dt, ORBIT_BASE_GATE, fastNext), "predictions one frame on");
+    expect(slowNext.gate > ORBIT_BASE_GATE, "gate grows with time since the last update");
+    expect(fastNext.gate - ORBIT_BASE_GATE > 5.0 * (slowNext.gate - ORBIT_BASE_GATE),
+           "gate grows with the spin rate");
+
+    // Outliers: off the predicted position while settled, off the
+    // tether length while not
+    const double aNext = 0.3 + 20.0 * (frames * dt);
+    expect(fast.accepts(tEnd + dt, ORBIT_BASE_GATE, endMassPose(aNext)), "predicted position accepted");
+    expect(!fast.accepts(tEnd + dt, ORBIT_BASE_GATE, endMassPose(aNext + 0.5 * M_PI)),
+           "quarter-turn outlier rejected");
+
+    OrbitModel fresh;
+    fresh.update(t0, satellitePose(), endMassPose(0.0));
+    fresh.update(t0 + dt, satellitePose(), endMassPose(0.5));
+    OrbitPrediction unused;
+    expect(!fresh.predict(t0 + 2 * dt, ORBIT_BASE_GATE, unused), "no prediction before the rate settles");
+    expect(fresh.accepts(t0 + 2 * dt, ORBIT_BASE_GATE, endMassPose(2.0)),
+           "unsettled: any angle at the tether length accepted");
+    expect(!fresh.accepts(t0 + 2 * dt, ORBIT_BASE_GATE, endMassPose(1.0, 2.0 * ORBIT_TETHER)),
+           "unsettled: off the tether length rejected");
+
+    // Lost for longer than ORBIT_TIMEOUT_S, then back spinning the other way
+    expect(fast.locked(tEnd + 0.9 * ORBIT_TIMEOUT_S), "lock held within the timeout");
+    const double tBack = tEnd + ORBIT_TIMEOUT_S + 0.1;
+    expect(!fast.locked(tBack), "lock dropped after the timeout");
+    expect(!fast.predict(tBack, ORBIT_BASE_GATE, unused), "no prediction without lock");
+
+    double backErr = 0.0;
+    expect(spin(fast, tBack, 2.5, -10.0, frames, backErr) == 0, "reacquired, nothing rejected");
+    expect(std::fabs(fast.omega() + 10.0) < 0.5, "rate settles at the new spin rate");
+    expect(backErr < ORBIT_MAX_ERR_M, "predictions follow the end mass after reacquisition");
+    return failures ? 1 : 0;
+}
+
+// ============================================================
+// MAIN
+// ============================================================
+
+int main(int argc, char** argv)
+{
+    const std::string check = argc > 1 ? argv[1] : "";
+    int status;
+    if      (check == "fusion")     status = checkFusion();
+    else if (check == "pose-cache") status = checkPoseCache();
+    else if (check == "orbit")      status = checkOrbit();
+    else
+    {
+        std::fprintf(stderr, "usage: tracker_checks fusion|pose-cache|orbit (see tracker_checks.cpp)\n");
+        return 2;
+    }
+    std::printf("%s: %s\n", check.c_str(), status == 0 ? "ok" : "FAILED");
+    return status;
+}
@@ -0,0 +1,137 @@
+// ============================================================
+// apriltag_tracker — Python bindings
+//
+//   import apriltag_tracker as at
+//   at.start(["--replay", "run01.frames"], history=4096)
+//   h = at.history()                  # NumPy views, no copies
+//   n = 0
+//   while at.running():
+//       n = at.wait_for_frame(n, timeout=1.0)
+//       row = (n - 1) % h["rows"]
+//       print(h["frame_id"][row], h["x"][row], h["y"][row])
+//   at.stop()
+//
+// The arrays in history() alias the tracker's ring (see pose_history.hpp)
+// and stay valid after stop().  Rows are overwritten as the ring wraps;
+// compare h["row_seq"][row] before and after reading a row to detect it.
+// ============================================================
+
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gst/gst.h>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "async_logger.hpp"
+#include "tracker.hpp"
+
+namespace py = pybind11;
+
+static std::mutex lifecycleMutex;
+
+static void start(const std::vector<std::string>& args, size_t history)
+{
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+
+    std::vector<std::string> argStore = { "apriltag_tracker" };
+    argStore.insert(argStore.end(), args.begin(), args.end());
+    std::vector<char*> argv;
+    for (auto& a : argStore) argv.push_back(&a[0]);
+
+    TrackerOptions opts;
+    if (!parseTrackerArgs(static_cast<int>(argv.size()), argv.data(), opts))
+        throw std::invalid_argument("bad tracker arguments (see stderr)");
+    opts.visualise   = false;   // no highgui windows from inside Python
+    opts.historyRows = history;
+
+    gst_init(nullptr, nullptr);
+    logger.start();
+
+    bool ok;
+    {
+        py::gil_scoped_release release;
+        ok = startTracker(opts);
+    }
+    if (!ok)
+    {
+        stopTracker();
+        throw std::runtime_error("tracker failed to start (see stderr)");
+    }
+}
+
+static void stop()
+{
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    py::gil_scoped_release release;
+    stopTracker();
+    logger.stop();
+}
+
+static uint64_t waitForFrame(uint64_t after, double timeout)
+{
+    auto history = poseHistory;
+    if (!history) throw std::runtime_error("tracker not started with history > 0");
+
+    py::gil_scoped_release release;
+    return history->waitFor(after, timeout);
+}
+
+// 1-D or 2-D array viewing `data`; the capsule keeps the history alive.
+template <typename T>
+static py::array view(const std::shared_ptr<PoseHistory>& h, T* data, bool perTag)
+{
+    auto* keep = new std::shared_ptr<PoseHistory>(h);
+    py::capsule owner(keep, [](void* p) { delete static_cast<std::shared_ptr<PoseHistory>*>(p); });
+
+    std::vector<py::ssize_t> shape = { static_cast<py::ssize_t>(h->rows()) };
+    if (perTag) shape.push_back(static_cast<py::ssize_t>(h->tags()));
+
+    py::array_t<T> arr(shape, data, owner);
+    arr.attr("setflags")(py::arg("write") = false);
+    return std::move(arr);
+}
+
+static py::dict history()
+{
+    auto h = poseHistory;
+    if (!h) throw std::runtime_error("tracker not started with history > 0");
+
+    static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+                  "row_seq is exposed as a plain uint64 array");
+
+    py::dict d;
+    d["rows"]     = h->rows();
+    d["tag_ids"]  = trackedTagIds();
+    d["row_seq"]  = view(h, reinterpret_cast<uint64_t*>(h->rowSeq.get()), false);
+    d["frame_id"] = view(h, h->frameId.data(), false);
+    d["timestamp"] = view(h, h->stamp.data(), false);
+    d["camera"]   = view(h, h->camera.data(), false);
+    d["x"]        = view(h, h->x.data(), true);
+    d["y"]        = view(h, h->y.data(), true);
+    d["yaw"]      = view(h, h->yaw.data(), true);
+    d["conf"]     = view(h, h->conf.data(), true);
+    d["visible"]  = view(h, h->visible.data(), true);
+    return d;
+}
+
+PYBIND11_MODULE(apriltag_tracker, m)
+{
+    m.doc() = "In-process AprilTag tracker with zero-copy pose history";
+
+    m.def("start", &start, py::arg("args") = std::vector<std::string>(),
+          py::arg("history") = 4096,
+          "Start capture/tracking with apriltag_demo command-line options");
+    m.def("stop", &stop, "Stop the tracker and join its threads");
+    m.def("running", &trackerRunning);
+    m.def("written", [] { return poseHistory ? poseHistory->written() : 0; },
+          "Frames appended to the history so far");
+    m.def("wait_for_frame", &waitForFrame, py::arg("after") = 0, py::arg("timeout") = 1.0,
+          "Block (GIL released) until more than `after` frames exist; returns the count");
+    m.def("history", &history,
+          "Dict of read-only NumPy views over the pose ring (per-tag arrays are rows x tags)");
+}
@@ -0,0 +1,276 @@
+#include "trajectory_log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "async_logger.hpp"
+
+// ============================================================
+// TRAJECTORY WRITER
+// ============================================================
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+    close();
+}
+
+bool TrajectoryWriter::open(const std::string& path, size_t stagingRows, double flushInterval)
+{
+    close();
+
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+    {
+        logError("Cannot create trajectory log %s", path.c_str());
+        return false;
+    }
+
+    uint8_t header[TRAJ_FILE_HEADER] = {};
+    TrajFileHeader h{};
+    std::memcpy(h.magic, TRAJ_MAGIC, sizeof(h.magic));
+    h.version   = TRAJ_VERSION;
+    h.blockRows = TRAJ_BLOCK_ROWS;
+    std::memcpy(header, &h, sizeof(h));
+    if (pwrite(fd_, header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)))
+    {
+        logError("Cannot write trajectory log %s", path.c_str());
+        close();
+        return false;
+    }
+
+    block_ = static_cast<TrajBlock*>(std::calloc(1, sizeof(TrajBlock)));
+    staging_.clear();
+    staging_.reserve(stagingRows);
+    draining_.clear();
+    draining_.reserve(stagingRows);
+
+    flushInterval_ = flushInterval;
+    blockIndex_    = 0;
+    flushedRows_   = 0;
+    dirty_         = false;
+    written_       = 0;
+    dropped_       = 0;
+    stop_          = false;
+    writer_        = std::thread(&TrajectoryWriter::writerLoop, this);
+
+    logInfo("Trajectory log -> %s", path.c_str());
+    return true;
+}
+
+void TrajectoryWriter::close()
+{
+    if (writer_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        writer_.join();
+        logInfo("Trajectory log closed: %llu rows, %llu dropped",
+                static_cast<unsigned long long>(written_.load()),
+                static_cast<unsigned long long>(dropped_.load()));
+    }
+
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+
+    std::free(block_);
+    block_ = nullptr;
+}
+
+bool TrajectoryWriter::append(const TrajRow& row)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0 || staging_.size() == staging_.capacity())
+    {
+        ++dropped_;
+        return false;
+    }
+    staging_.push_back(row);
+    return true;
+}
+
+void TrajectoryWriter::writerLoop()
+{
+    const auto interval = std::chrono::duration<double>(flushInterval_);
+    auto nextFlush = std::chrono::steady_clock::now() + interval;
+
+    while (true)
+    {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait_for(lock, std::chrono::milliseconds(100));
+            stopping = stop_;
+            staging_.swap(draining_);   // equal capacities, no reallocation
+        }
+
+        for (const TrajRow& r : draining_)
+        {
+            const uint32_t i = block_->rows;
+            block_->seq[i]   = r.seq;
+            block_->stamp[i] = r.stamp;
+            block_->x[i]     = r.x;
+            block_->y[i]     = r.y;
+            block_->yaw[i]   = r.yaw;
+            block_->conf[i]  = r.conf;
+            block_->tag[i]   = r.tag;
+            block_->flags[i] = r.flags;
+            ++block_->rows;
+            dirty_ = true;
+
+            if (block_->rows == TRAJ_BLOCK_ROWS)
+            {
+                flushBlock();
+                ++blockIndex_;
+                flushedRows_ = 0;
+                std::memset(block_, 0, sizeof(TrajBlock));
+            }
+        }
+        written_ += draining_.size();
+        draining_.clear();
+
+        if (stopping || std::chrono::steady_clock::now() >= nextFlush)
+        {
+            flushBlock();
+            nextFlush = std::chrono::steady_clock::now() + interval;
+        }
+        if (stopping) return;
+    }
+}
+
+// Rows [from, to) of the column at `column` bytes into the block
+template <class T>
+static bool writeColumn(int fd, off_t block, size_t column, const T* values,
+                        uint32_t from, uint32_t to)
+{
+    const size_t bytes = size_t(to - from) * sizeof(T);
+    return pwrite(fd, values + from, bytes, block + off_t(column + from * sizeof(T))) ==
+           static_cast<ssize_t>(bytes);
+}
+
+void TrajectoryWriter::flushBlock()
+{
+    if (!dirty_) return;
+
+    const off_t block = TRAJ_FILE_HEADER + off_t(blockIndex_) * off_t(sizeof(TrajBlock));
+    const uint32_t from = flushedRows_, to = block_->rows;
+
+    bool ok = flushedRows_ > 0 || ftruncate(fd_, block + off_t(sizeof(TrajBlock))) == 0;
+    ok = ok && writeColumn(fd_, block, offsetof(TrajBlock, seq),   block_->seq,   from, to)
+            && writeColumn(fd_, block, offsetof(TrajBlock, stamp), block_->stamp, from, to)
+            && writeColumn(fd_, block, offsetof(TrajBlock, x),     block_->x,     from, to)
+            && writeColumn(fd_, block, offsetof(TrajBlock, y),     block_->y,     from, to)
+            && writeColumn(fd_, block, offsetof(TrajBlock, yaw),   block_->yaw,   from, to)
+            && writeColumn(fd_, block, offsetof(TrajBlock, conf),  block_->conf,  from, to)
+            && writeColumn(fd_, block, offsetof(TrajBlock, tag),   block_->tag,   from, to)
+            && writeColumn(fd_, block, offsetof(TrajBlock, flags), block_->flags, from, to);
+
+    // Row count last, so a reader never counts rows that are not written
+    const size_t head = offsetof(TrajBlock, seq);
+    ok = ok && pwrite(fd_, block_, head, block) == static_cast<ssize_t>(head);
+    if (!ok) logWarn("Trajectory log write failed");
+
+    flushedRows_ = to;
+    dirty_       = false;
+}
+
+// ============================================================
+// TRAJECTORY READER
+// ============================================================
+
+TrajectoryReader::~TrajectoryReader()
+{
+    close();
+}
+
+bool TrajectoryReader::open(const std::string& path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        logError("Cannot open trajectory log %s", path.c_str());
+        return false;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < TRAJ_FILE_HEADER)
+    {
+        logError("Trajectory log too small: %s", path.c_str());
+        ::close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+    {
+        logError("mmap failed for %s", path.c_str());
+        return false;
+    }
+
+    base_   = static_cast<uint8_t*>(p);
+    length_ = st.st_size;
+
+    const auto& h = *reinterpret_cast<const TrajFileHeader*>(base_);
+    if (std::memcmp(h.magic, TRAJ_MAGIC, sizeof(h.magic)) != 0 ||
+        h.version != TRAJ_VERSION || h.blockRows != TRAJ_BLOCK_ROWS)
+    {
+        logError("Not a trajectory log (bad header): %s", path.c_str());
+        close();
+        return false;
+    }
+
+    blocks_ = (length_ - TRAJ_FILE_HEADER) / sizeof(TrajBlock);
+    rows_   = 0;
+    for (size_t b = 0; b < blocks_; ++b)
+        rows_ += std::min<uint32_t>(block(b).rows, TRAJ_BLOCK_ROWS);
+
+    madvise(base_, length_, MADV_SEQUENTIAL);
+    return true;
+}
+
+void TrajectoryReader::close()
+{
+    if (base_) munmap(base_, length_);
+    base_   = nullptr;
+    length_ = 0;
+    blocks_ = 0;
+    rows_   = 0;
+}
+
+TrajRow TrajectoryReader::iterator::operator*() const
+{
+    const TrajBlock& blk = r_->block(b_);
+    TrajRow row;
+    row.seq   = blk.seq[i_];
+    row.stamp = blk.stamp[i_];
+    row.x     = blk.x[i_];
+    row.y     = blk.y[i_];
+    row.yaw   = blk.yaw[i_];
+    row.conf  = blk.conf[i_];
+    row.tag   = blk.tag[i_];
+    row.flags = blk.flags[i_];
+    return row;
+}
+
+void TrajectoryReader::iterator::skipEmpty()
+{
+    while (b_ < r_->blocks_ && i_ >= std::min<uint32_t>(r_->block(b_).rows, TRAJ_BLOCK_ROWS))
+    {
+        ++b_;
+        i_ = 0;
+    }
+    if (b_ >= r_->blocks_) i_ = 0;
+}
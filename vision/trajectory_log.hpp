@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================
+// TRAJECTORY LOG
+//
+// Append-only binary log of per-tag poses.  After a 64-byte file header
+// the file is a sequence of fixed-size blocks; each block holds up to
+// TRAJ_BLOCK_ROWS rows stored column by column (all seq values, then all
+// stamps, ...).  Blocks never move once allocated, so a reader can mmap
+// the file and jump to block b directly, and analysis code can scan one
+// column without touching the others.
+//
+// Row = one tag in one frame: seq, capture time, x, y, yaw, conf, tag, flags.
+// ============================================================
+
+constexpr char     TRAJ_MAGIC[8]    = { 'T','R','A','J','L','O','G','1' };
+constexpr uint32_t TRAJ_VERSION     = 1;
+constexpr uint32_t TRAJ_BLOCK_ROWS  = 4096;
+constexpr size_t   TRAJ_FILE_HEADER = 64;
+
+// flags
+constexpr uint16_t TRAJ_VISIBLE       = 1u << 0;
+constexpr int      TRAJ_CAMERA_SHIFT  = 8;     // bits 8..15: camera index
+
+struct TrajFileHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t blockRows;
+};
+
+// One block, exactly as laid out on disk.
+struct TrajBlock
+{
+    uint32_t rows;
+    uint32_t reserved;
+    uint64_t seq  [TRAJ_BLOCK_ROWS];   // tracker frame id
+    double   stamp[TRAJ_BLOCK_ROWS];   // unix seconds at capture
+    float    x    [TRAJ_BLOCK_ROWS];   // metres, world frame
+    float    y    [TRAJ_BLOCK_ROWS];
+    float    yaw  [TRAJ_BLOCK_ROWS];   // degrees
+    float    conf [TRAJ_BLOCK_ROWS];
+    uint16_t tag  [TRAJ_BLOCK_ROWS];   // AprilTag ID
+    uint16_t flags[TRAJ_BLOCK_ROWS];
+};
+
+static_assert(sizeof(TrajFileHeader) <= TRAJ_FILE_HEADER, "trajectory header too large");
+
+struct TrajRow
+{
+    uint64_t seq   = 0;
+    double   stamp = 0.0;
+    float    x     = 0.f;
+    float    y     = 0.f;
+    float    yaw   = 0.f;
+    float    conf  = 0.f;
+    uint16_t tag   = 0;
+    uint16_t flags = 0;
+};
+
+// ============================================================
+// TRAJECTORY WRITER
+//
+// append() only copies the row into a bounded staging buffer (rows are
+// dropped and counted if it is full); a background thread moves staged
+// rows into the current block and, about once per flushInterval, writes
+// the rows added since the last flush -- each column's new slice, then
+// the block's row count -- so at most that much is lost on a crash and
+// the bytes written stay close to the bytes logged.  A block's full
+// extent is reserved (sparse) when it starts, so readers always map
+// whole blocks.
+// ============================================================
+
+class TrajectoryWriter
+{
+public:
+    TrajectoryWriter() = default;
+    ~TrajectoryWriter();
+
+    TrajectoryWriter(const TrajectoryWriter&)            = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    bool open(const std::string& path, size_t stagingRows = 8192,
+              double flushInterval = 1.0);
+    void close();
+
+    bool isOpen() const { return fd_ >= 0; }
+
+    // Thread-safe, never blocks on I/O.  Returns false if dropped.
+    bool append(const TrajRow& row);
+
+    uint64_t written() const { return written_; }
+    uint64_t dropped() const { return dropped_; }
+
+private:
+    void writerLoop();
+    void flushBlock();
+
+    int    fd_            = -1;
+    double flushInterval_ = 1.0;
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    bool                    stop_ = false;
+    std::vector<TrajRow>    staging_;    // producers -> writer, guarded by mutex_
+    std::vector<TrajRow>    draining_;   // writer thread only
+    std::thread             writer_;
+
+    // Writer thread only
+    TrajBlock* block_       = nullptr;
+    uint64_t   blockIndex_  = 0;
+    uint32_t   flushedRows_ = 0;   // rows of block_ already on disk
+    bool       dirty_       = false;
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+// ============================================================
+// TRAJECTORY READER
+//
+// Read-only mmap of a trajectory log.  Iterate rows with a range-for, or
+// walk block(b) for column-wise access.
+// ============================================================
+
+class TrajectoryReader
+{
+public:
+    TrajectoryReader() = default;
+    ~TrajectoryReader();
+
+    TrajectoryReader(const TrajectoryReader&)            = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    size_t           blockCount() const { return blocks_; }
+    const TrajBlock& block(size_t b) const
+    {
+        return *reinterpret_cast<const TrajBlock*>(base_ + TRAJ_FILE_HEADER + b * sizeof(TrajBlock));
+    }
+    size_t           rowCount() const { return rows_; }
+
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = TrajRow;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const TrajRow*;
+        using reference         = TrajRow;
+
+        iterator(const TrajectoryReader* r, size_t b, size_t i) : r_(r), b_(b), i_(i) { skipEmpty(); }
+
+        TrajRow operator*() const;
+        iterator& operator++() { ++i_; skipEmpty(); return *this; }
+        bool operator==(const iterator& o) const { return b_ == o.b_ && i_ == o.i_; }
+        bool operator!=(const iterator& o) const { return !(*this == o); }
+
+    private:
+        void skipEmpty();
+
+        const TrajectoryReader* r_;
+        size_t b_, i_;
+    };
+
+    iterator begin() const { return iterator(this, 0, 0); }
+    iterator end()   const { return iterator(this, blocks_, 0); }
+
+private:
+    uint8_t* base_   = nullptr;
+    size_t   length_ = 0;
+    size_t   blocks_ = 0;
+    size_t   rows_   = 0;
+};
@@ -0,0 +1,85 @@
+// ============================================================
+// trajlog_dump — print a trajectory log (see trajectory_log.hpp)
+//
+//   trajlog_dump run.traj              CSV of every row
+//   trajlog_dump run.traj --tag 1      CSV of one tag
+//   trajlog_dump run.traj --summary    per-tag row counts and time span
+// ============================================================
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "trajectory_log.hpp"
+
+struct TagSummary
+{
+    uint64_t rows    = 0;
+    uint64_t visible = 0;
+    double   first   = 0.0;
+    double   last    = 0.0;
+    double   confSum = 0.0;
+};
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: trajlog_dump <file> [--tag <id>] [--summary]\n";
+        return 2;
+    }
+
+    int  onlyTag = -1;
+    bool summary = false;
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if      (arg == "--tag" && i + 1 < argc) onlyTag = std::atoi(argv[++i]);
+        else if (arg == "--summary")             summary = true;
+    }
+
+    TrajectoryReader log;
+    if (!log.open(argv[1])) return 1;
+
+    if (summary)
+    {
+        std::map<int, TagSummary> tags;
+        for (const TrajRow r : log)
+        {
+            TagSummary& t = tags[r.tag];
+            if (t.rows == 0) t.first = r.stamp;
+            t.last = r.stamp;
+            ++t.rows;
+            if (r.flags & TRAJ_VISIBLE)
+            {
+                ++t.visible;
+                t.confSum += r.conf;
+            }
+        }
+
+        std::printf("%zu rows in %zu blocks\n", log.rowCount(), log.blockCount());
+        for (const auto& [id, t] : tags)
+        {
+            std::printf("tag %3d: %8llu rows, %5.1f%% visible, mean conf %.3f, %.1f s\n",
+                        id, static_cast<unsigned long long>(t.rows),
+                        t.rows ? 100.0 * t.visible / t.rows : 0.0,
+                        t.visible ? t.confSum / t.visible : 0.0,
+                        t.last - t.first);
+        }
+        return 0;
+    }
+
+    std::printf("seq,stamp,camera,tag,x,y,yaw,conf,visible\n");
+    for (const TrajRow r : log)
+    {
+        if (onlyTag >= 0 && r.tag != onlyTag) continue;
+        std::printf("%llu,%.6f,%d,%d,%.4f,%.4f,%.4f,%.3f,%d\n",
+                    static_cast<unsigned long long>(r.seq), r.stamp,
+                    r.flags >> TRAJ_CAMERA_SHIFT, r.tag,
+                    r.x, r.y, r.yaw, r.conf,
+                    (r.flags & TRAJ_VISIBLE) ? 1 : 0);
+    }
+    return 0;
+}
@@ -0,0 +1,481 @@
+#include "ws_server.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "async_logger.hpp"
+#include "trace.hpp"
+
+constexpr size_t WS_MAX_CLIENTS   = 32;
+constexpr size_t WS_MAX_REQUEST   = 8192;    // handshake bytes
+constexpr size_t WS_MAX_INBOUND   = 65536;   // buffered client -> server bytes
+constexpr char   WS_GUID[]        = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+// ============================================================
+// HANDSHAKE HELPERS (SHA-1 + base64 for Sec-WebSocket-Accept)
+// ============================================================
+
+static uint32_t rol(uint32_t v, int s) { return (v << s) | (v >> (32 - s)); }
+
+static void sha1(const std::string& msg, uint8_t digest[20])
+{
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+
+    std::string m = msg;
+    const uint64_t bits = static_cast<uint64_t>(msg.size()) * 8;
+    m += static_cast<char>(0x80);
+    while (m.size() % 64 != 56) m += '\0';
+    for (int i = 7; i >= 0; --i) m += static_cast<char>((bits >> (i * 8)) & 0xFF);
+
+    for (size_t off = 0; off < m.size(); off += 64)
+    {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i)
+        {
+            const auto* p = reinterpret_cast<const uint8_t*>(m.data() + off + i * 4);
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+                   (uint32_t(p[2]) << 8)  |  uint32_t(p[3]);
+        }
+        for (int i = 16; i < 80; ++i)
+            w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i)
+        {
+            uint32_t f, k;
+            if      (i < 20) { f = (b & c) | (~b & d);          k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+            const uint32_t t = rol(a, 5) + f + e + k + w[i];
+            e = d; d = c; c = rol(b, 30); b = a; a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    for (int i = 0; i < 5; ++i)
+        for (int j = 0; j < 4; ++j)
+            digest[i * 4 + j] = static_cast<uint8_t>(h[i] >> (24 - j * 8));
+}
+
+static std::string base64(const uint8_t* data, size_t len)
+{
+    static const char tbl[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < len; i += 3)
+    {
+        uint32_t v = uint32_t(data[i]) << 16;
+        if (i + 1 < len) v |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < len) v |= data[i + 2];
+        out += tbl[(v >> 18) & 63];
+        out += tbl[(v >> 12) & 63];
+        out += i + 1 < len ? tbl[(v >> 6) & 63] : '=';
+        out += i + 2 < len ? tbl[v & 63] : '=';
+    }
+    return out;
+}
+
+// Value of a request header, matched case-insensitively; empty if absent.
+static std::string headerValue(const std::string& req, const char* name)
+{
+    const size_t nameLen = std::strlen(name);
+    size_t pos = req.find("\r\n");
+    while (pos != std::string::npos && pos + 2 < req.size())
+    {
+        const size_t start = pos + 2;
+        const size_t end   = req.find("\r\n", start);
+        if (end == std::string::npos) break;
+        if (end - start > nameLen && req[start + nameLen] == ':' &&
+            strncasecmp(req.c_str() + start, name, nameLen) == 0)
+        {
+            size_t v = start + nameLen + 1;
+            while (v < end && (req[v] == ' ' || req[v] == '\t')) ++v;
+            size_t e = end;
+            while (e > v && (req[e - 1] == ' ' || req[e - 1] == '\t')) --e;
+            return req.substr(v, e - v);
+        }
+        pos = end;
+    }
+    return {};
+}
+
+static double nowSeconds()
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ============================================================
+// WEBSOCKET SERVER
+// ============================================================
+
+WsServer::~WsServer()
+{
+    stop();
+}
+
+bool WsServer::start(int port, double maxHz)
+{
+    stop();
+
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0)
+    {
+        logError("WebSocket server: socket() failed: %s", std::strerror(errno));
+        return false;
+    }
+
+    int one = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listenFd_, 8) < 0)
+    {
+        logError("WebSocket server: cannot listen on port %d: %s", port, std::strerror(errno));
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0)
+    {
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    maxHz_      = maxHz > 0.0 ? maxHz : 30.0;
+    payloadSeq_ = 0;
+    payload_.clear();
+    stop_       = false;
+    thread_     = std::thread(&WsServer::serverLoop, this);
+
+    logInfo("WebSocket server on ws://0.0.0.0:%d (max %.0f Hz per client)", port, maxHz_);
+    return true;
+}
+
+void WsServer::stop()
+{
+    if (thread_.joinable())
+    {
+        stop_ = true;
+        const uint64_t one = 1;
+        (void)!write(wakeFd_, &one, sizeof(one));
+        thread_.join();
+    }
+
+    for (auto& c : clients_)
+        ::close(c.fd);
+    clients_.clear();
+    clientCount_ = 0;
+
+    if (listenFd_ >= 0) ::close(listenFd_);
+    if (wakeFd_   >= 0) ::close(wakeFd_);
+    listenFd_ = -1;
+    wakeFd_   = -1;
+}
+
+void WsServer::publish(const std::string& text)
+{
+    if (listenFd_ < 0) return;
+    {
+        std::lock_guard<std::mutex> lock(payloadMutex_);
+        payload_ = text;
+        ++payloadSeq_;
+    }
+    const uint64_t one = 1;
+    (void)!write(wakeFd_, &one, sizeof(one));
+}
+
+void WsServer::acceptClients()
+{
+    for (;;)
+    {
+        const int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+
+        if (clients_.size() >= WS_MAX_CLIENTS)
+        {
+            ::close(fd);
+            continue;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        Client c;
+        c.fd          = fd;
+        c.minInterval = 1.0 / maxHz_;
+        clients_.push_back(std::move(c));
+    }
+}
+
+bool WsServer::readClient(Client& c)
+{
+    char buf[4096];
+    for (;;)
+    {
+        const ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+        if (n > 0)
+        {
+            c.in.append(buf, static_cast<size_t>(n));
+            if (c.in.size() > WS_MAX_INBOUND) return false;
+            continue;
+        }
+        if (n == 0) return false;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        if (errno == EINTR) continue;
+        return false;
+    }
+    return c.upgraded ? parseFrames(c) : handshake(c);
+}
+
+bool WsServer::handshake(Client& c)
+{
+    const size_t end = c.in.find("\r\n\r\n");
+    if (end == std::string::npos)
+        return c.in.size() <= WS_MAX_REQUEST;
+
+    const std::string req = c.in.substr(0, end + 2);
+    c.in.erase(0, end + 4);
+
+    const std::string key = headerValue(req, "Sec-WebSocket-Key");
+    if (req.compare(0, 4, "GET ") != 0 || key.empty())
+    {
+        static const char bad[] = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
+        (void)send(c.fd, bad, sizeof(bad) - 1, MSG_NOSIGNAL);
+        return false;
+    }
+
+    // Optional per-client rate: GET /?hz=10
+    const size_t lineEnd = req.find("\r\n");
+    const size_t hzPos   = req.find("hz=");
+    if (hzPos != std::string::npos && hzPos < lineEnd)
+    {
+        const double hz = std::atof(req.c_str() + hzPos + 3);
+        if (hz > 0.0) c.minInterval = 1.0 / std::min(hz, maxHz_);
+    }
+
+    uint8_t digest[20];
+    sha1(key + WS_GUID, digest);
+
+    c.out =
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: " + base64(digest, sizeof(digest)) + "\r\n\r\n";
+    c.outOff   = 0;
+    c.upgraded = true;
+    ++clientCount_;
+    return parseFrames(c);
+}
+
+bool WsServer::parseFrames(Client& c)
+{
+    for (;;)
+    {
+        if (c.in.size() < 2) return true;
+        const auto* p = reinterpret_cast<const uint8_t*>(c.in.data());
+
+        const uint8_t opcode = p[0] & 0x0F;
+        const bool    masked = (p[1] & 0x80) != 0;
+        uint64_t len  = p[1] & 0x7F;
+        size_t   head = 2;
+        if (len == 126)
+        {
+            if (c.in.size() < 4) return true;
+            len  = (uint64_t(p[2]) << 8) | p[3];
+            head = 4;
+        }
+        else if (len == 127)
+        {
+            if (c.in.size() < 10) return true;
+            len = 0;
+            for (int i = 0; i < 8; ++i) len = (len << 8) | p[2 + i];
+            head = 10;
+        }
+        if (len > WS_MAX_INBOUND) return false;
+        if (masked) head += 4;
+        if (c.in.size() < head + len) return true;
+
+        std::string data = c.in.substr(head, len);
+        if (masked)
+        {
+            const uint8_t* mask = p + head - 4;
+            for (size_t i = 0; i < data.size(); ++i)
+                data[i] = static_cast<char>(data[i] ^ mask[i & 3]);
+        }
+        c.in.erase(0, head + len);
+
+        if (opcode == 0x8)        // close: echo the status and hang up once sent
+        {
+            queueFrame(c, 0x8, data.data(), std::min<size_t>(data.size(), 2));
+            c.closing = true;
+            return true;
+        }
+        if (opcode == 0x9)        // ping
+            queueFrame(c, 0xA, data.data(), data.size());
+        // Text/binary/pong from the GUI are ignored; the stream is one-way.
+    }
+}
+
+void WsServer::queueFrame(Client& c, uint8_t opcode, const char* data, size_t len)
+{
+    if (c.outOff == c.out.size())
+    {
+        c.out.clear();
+        c.outOff = 0;
+    }
+
+    c.out += static_cast<char>(0x80 | opcode);
+    if (len < 126)
+    {
+        c.out += static_cast<char>(len);
+    }
+    else if (len < 65536)
+    {
+        c.out += static_cast<char>(126);
+        c.out += static_cast<char>((len >> 8) & 0xFF);
+        c.out += static_cast<char>(len & 0xFF);
+    }
+    else
+    {
+        c.out += static_cast<char>(127);
+        for (int i = 7; i >= 0; --i)
+            c.out += static_cast<char>((uint64_t(len) >> (i * 8)) & 0xFF);
+    }
+    c.out.append(data, len);
+}
+
+bool WsServer::flushClient(Client& c)
+{
+    while (c.outOff < c.out.size())
+    {
+        const ssize_t n = send(c.fd, c.out.data() + c.outOff, c.out.size() - c.outOff,
+                               MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0)
+        {
+            c.outOff += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        return false;
+    }
+    c.out.clear();
+    c.outOff = 0;
+    return !c.closing;
+}
+
+void WsServer::serverLoop()
+{
+    traceThread("ws server");
+    std::string latest;
+    uint64_t    latestSeq = 0;
+    std::vector<pollfd> fds;
+
+    while (!stop_)
+    {
+        // Sleep until I/O, a publish(), or the next rate-limited send is due
+        const double now = nowSeconds();
+        int timeoutMs = -1;
+        for (const auto& c : clients_)
+        {
+            if (!c.upgraded || c.closing || c.sentSeq >= latestSeq || !c.out.empty())
+                continue;
+            const int ms = static_cast<int>(std::max(0.0, c.nextSend - now) * 1000.0) + 1;
+            timeoutMs = timeoutMs < 0 ? ms : std::min(timeoutMs, ms);
+        }
+
+        fds.clear();
+        fds.push_back({ listenFd_, POLLIN, 0 });
+        fds.push_back({ wakeFd_,   POLLIN, 0 });
+        for (const auto& c : clients_)
+        {
+            short ev = POLLIN;
+            if (c.outOff < c.out.size()) ev |= POLLOUT;
+            fds.push_back({ c.fd, ev, 0 });
+        }
+
+        if (poll(fds.data(), fds.size(), timeoutMs) < 0 && errno != EINTR)
+            break;
+
+        if (fds[1].revents & POLLIN)
+        {
+            uint64_t v;
+            (void)!read(wakeFd_, &v, sizeof(v));
+        }
+
+        // Accept after sizing `alive`, so new clients sit past its end
+        // until the next pass (as in the MJPEG server)
+        std::vector<bool> alive(clients_.size(), true);
+        for (size_t i = 0; i + 2 < fds.size(); ++i)
+        {
+            Client& c = clients_[i];
+            const short re = fds[i + 2].revents;
+            if (re & (POLLERR | POLLHUP | POLLNVAL)) alive[i] = false;
+            else if ((re & POLLIN) && !readClient(c)) alive[i] = false;
+        }
+        if (fds[0].revents & POLLIN)
+            acceptClients();
+
+        {
+            std::lock_guard<std::mutex> lock(payloadMutex_);
+            if (payloadSeq_ != latestSeq)
+            {
+                latest    = payload_;
+                latestSeq = payloadSeq_;
+            }
+        }
+
+        const double t = nowSeconds();
+        for (size_t i = 0; i < clients_.size(); ++i)
+        {
+            if (i < alive.size() && !alive[i]) continue;
+            Client& c = clients_[i];
+            if (c.upgraded && !c.closing && c.out.empty() &&
+                c.sentSeq < latestSeq && t >= c.nextSend)
+            {
+                queueFrame(c, 0x1, latest.data(), latest.size());
+                c.sentSeq  = latestSeq;
+                // Keep the cadence unless we fell a whole interval behind
+                c.nextSend = (t - c.nextSend < c.minInterval) ? c.nextSend + c.minInterval
+                                                              : t + c.minInterval;
+            }
+            if (!flushClient(c) && i < alive.size()) alive[i] = false;
+            else if (c.closing && c.out.empty() && i < alive.size()) alive[i] = false;
+        }
+
+        // Drop dead clients (newly accepted ones are past alive.size())
+        size_t keep = 0;
+        for (size_t i = 0; i < clients_.size(); ++i)
+        {
+            if (i < alive.size() && !alive[i])
+            {
+                if (clients_[i].upgraded) --clientCount_;
+                ::close(clients_[i].fd);
+                continue;
+            }
+            if (keep != i) clients_[keep] = std::move(clients_[i]);
+            ++keep;
+        }
+        clients_.resize(keep);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================
+// WEBSOCKET SERVER
+//
+// Minimal RFC 6455 text-frame broadcaster for the GUI data stream.
+// publish() only swaps the latest payload under a mutex and wakes the
+// server thread; all socket work (accept, handshake, framing, writes)
+// happens there on non-blocking sockets.
+//
+// Each client gets the newest payload at most maxHz times per second
+// (a client may ask for less with "ws://host:port/?hz=10").  A client
+// is never sent a new frame while its previous one is still queued, so
+// a slow reader simply sees a lower rate instead of a growing backlog.
+// ============================================================
+
+class WsServer
+{
+public:
+    WsServer() = default;
+    ~WsServer();
+
+    WsServer(const WsServer&)            = delete;
+    WsServer& operator=(const WsServer&) = delete;
+
+    bool start(int port, double maxHz = 30.0);
+    void stop();
+
+    bool running() const { return listenFd_ >= 0; }
+
+    // Replace the payload to broadcast (latest wins).
+    void publish(const std::string& text);
+
+    size_t clientCount() const { return clientCount_; }
+
+private:
+    struct Client
+    {
+        int         fd          = -1;
+        bool        upgraded    = false;
+        bool        closing     = false;
+        double      minInterval = 0.0;
+        double      nextSend    = 0.0;
+        uint64_t    sentSeq     = 0;
+        std::string in;
+        std::string out;
+        size_t      outOff      = 0;
+    };
+
+    void serverLoop();
+    void acceptClients();
+    bool readClient(Client& c);
+    bool handshake(Client& c);
+    bool parseFrames(Client& c);
+    bool flushClient(Client& c);
+    void queueFrame(Client& c, uint8_t opcode, const char* data, size_t len);
+
+    int    listenFd_ = -1;
+    int    wakeFd_   = -1;
+    double maxHz_    = 30.0;
+
+    std::mutex  payloadMutex_;
+    std::string payload_;
+    uint64_t    payloadSeq_ = 0;
+
+    std::vector<Client>  clients_;   // server thread only
+    std::atomic<size_t>  clientCount_{0};
+    std::atomic<bool>    stop_{false};
+    std::thread          thread_;
+};